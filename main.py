@@ -21,6 +21,17 @@ parser.add_argument('--seed', type=int, default=12312)
 parser.add_argument('--mixture_size', type=int, default=4)
 parser.add_argument('--num_replicas', type=int, default=5)
 parser.add_argument('--threads_likelihood', type=int, default=4)
+parser.add_argument('--mtm_tries', type=int, default=1)
+parser.add_argument('--speculative_steps', type=int, default=1)
+parser.add_argument('--delayed_acceptance_cells', type=int, default=0)
+parser.add_argument('--approximate_replicas_cells', type=int, default=0)
+parser.add_argument('--exact_replicas', type=int, default=1)
+parser.add_argument('--move_type_adaptation_steps', type=int, default=0)
+parser.add_argument('--informed_label_proposals', type=bool, default=False)
+parser.add_argument('--informed_reattachment', type=bool, default=False)
+parser.add_argument('--max_event_loci', type=int, default=0)
+parser.add_argument('--max_event_length', type=float, default=0.0)
+parser.add_argument('--precision', type=str, default="double")
 parser.add_argument('--verbose', type=bool, default=True)
 parser.add_argument('--neutral_cn', type=float, default=2.0)
 parser.add_argument('--output_dir', type=str, default='./')
@@ -63,6 +74,17 @@ if __name__ == "__main__":
         mixture_size=args.mixture_size,
         num_replicas=args.num_replicas,
         threads_likelihood=args.threads_likelihood,
+        mtm_tries=args.mtm_tries,
+        speculative_steps=args.speculative_steps,
+        delayed_acceptance_cells=args.delayed_acceptance_cells,
+        approximate_replicas_cells=args.approximate_replicas_cells,
+        exact_replicas=args.exact_replicas,
+        move_type_adaptation_steps=args.move_type_adaptation_steps,
+        informed_label_proposals=args.informed_label_proposals,
+        informed_reattachment=args.informed_reattachment,
+        max_event_loci=args.max_event_loci,
+        max_event_length=args.max_event_length,
+        precision=args.precision,
         verbose=args.verbose,
         neutral_cn=args.neutral_cn,
         output_dir=args.output_dir
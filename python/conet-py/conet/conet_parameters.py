@@ -17,6 +17,17 @@ class CONETParameters:
     mixture_size: int = 4
     num_replicas: int = 5
     threads_likelihood: int = 4
+    mtm_tries: int = 1
+    speculative_steps: int = 1
+    delayed_acceptance_cells: int = 0
+    approximate_replicas_cells: int = 0
+    exact_replicas: int = 1
+    move_type_adaptation_steps: int = 0
+    informed_label_proposals: bool = False
+    informed_reattachment: bool = False
+    max_event_loci: int = 0
+    max_event_length: float = 0.0
+    precision: str = "double"
     verbose: bool = True
     neutral_cn: float = 2.0
     output_dir: str = "./"
@@ -19,6 +19,23 @@ using namespace std;
 
 namespace po = boost::program_options;
 
+template <class Real_t>
+void run_inference(string data_dir, string output_dir, int param_inf_iters, int pt_inf_iters) {
+	Random<Real_t> random(SEED);
+    CONETInputData<Real_t> provider = create_from_file<Real_t>(string(data_dir).append("ratios"), string(data_dir).append("counts"), string(data_dir).append("counts_squared"), ';');
+    
+    log("Input files have been loaded successfully");
+    ParallelTemperingCoordinator<Real_t> PT(provider, random);
+	CONETInferenceResult<Real_t> result = PT.simulate(param_inf_iters, pt_inf_iters);
+	log("Tree inference has finished");
+
+	std::ofstream tree_file{ string(output_dir).append("inferred_tree") };
+	tree_file << TreeFormatter::to_string_representation(result.tree);
+
+	std::ofstream attachment_file{ string(output_dir).append("inferred_attachment") };
+	attachment_file << result.attachment;
+}
+
 int main(int argc, char **argv) {
 	po::options_description description("MyTool Usage");
 
@@ -36,6 +53,17 @@ int main(int argc, char **argv) {
 		("mixture_size",  po::value<size_t>()->default_value(4), "Initial number of components in difference distribution for breakpoint loci.")
 		("num_replicas",  po::value<size_t>()->default_value(5), "Number of tempered chain replicas in MAP event tree search.")
 		("threads_likelihood",  po::value<size_t>()->default_value(4), "Number of threads which will be used for the most demanding likelihood calculations.")
+		("mtm_tries",  po::value<size_t>()->default_value(1), "Number of proposals evaluated in parallel per step of multiple-try Metropolis in tree inference. Value 1 means ordinary Metropolis-Hastings steps.")
+		("speculative_steps",  po::value<size_t>()->default_value(1), "Number of consecutive MH steps of tree inference which are evaluated in parallel, assuming that moves are rejected. The chain does not depend on this value. Ignored if mtm_tries is larger than 1.")
+		("delayed_acceptance_cells",  po::value<size_t>()->default_value(0), "If positive, moves in tree inference are first accepted or rejected based on likelihood of this many randomly chosen cells and only moves which pass are scored on all cells. Ignored if mtm_tries or speculative_steps is larger than 1.")
+		("approximate_replicas_cells",  po::value<size_t>()->default_value(0), "If positive, tree inference replicas other than the first exact_replicas ones score trees on this many randomly chosen cells. Exact likelihood is calculated only when such replica's tree is swapped with an exact replica. Ignored if mtm_tries or speculative_steps is larger than 1.")
+		("exact_replicas",  po::value<size_t>()->default_value(1), "Number of replicas with the highest temperatures which score trees on all cells, used with approximate_replicas_cells.")
+		("move_type_adaptation_steps",  po::value<size_t>()->default_value(0), "Number of initial MH steps of each tree inference replica during which move type probabilities are adapted towards move types accepted most often per likelihood evaluation cost. Probabilities are fixed afterwards.")
+		("informed_label_proposals",  po::value<bool>()->default_value(false), "If True, labels of new tree nodes are proposed more often at loci with high breakpoint evidence in the data, otherwise uniformly.")
+		("informed_reattachment",  po::value<bool>()->default_value(false), "If True, pruned subtrees are reattached more often below nodes whose cells support breakpoints of the subtree root. Ignored with speculative steps, delayed acceptance and for replicas with approximate likelihood.")
+		("max_event_loci",  po::value<size_t>()->default_value(0), "Maximal number of loci spanned by an event, i.e. maximal difference of its breakpoints. Longer events are never proposed. 0 means no limit.")
+		("max_event_length",  po::value<double>()->default_value(0.0), "Maximal genomic length of an event, calculated from bin lengths as in the events length penalty. Longer events are never proposed. 0 means no limit.")
+		("precision",  po::value<string>()->default_value("double"), "Floating point precision of inference, double or float. In float mode per cell likelihoods are still summed up in double precision.")
 		("verbose",  po::value<bool>()->default_value(true), "True if CONET should print messages during inference.")
 		("neutral_cn",  po::value<double>()->default_value(2.0), "Neutral copy number");
 	
@@ -60,21 +88,27 @@ int main(int argc, char **argv) {
 	MIXTURE_SIZE = vm["mixture_size"].as<size_t>();
 	NUM_REPLICAS = vm["num_replicas"].as<size_t>();
 	THREADS_LIKELIHOOD = vm["threads_likelihood"].as<size_t>();
+	MTM_TRIES = vm["mtm_tries"].as<size_t>();
+	SPECULATIVE_STEPS = vm["speculative_steps"].as<size_t>();
+	DELAYED_ACCEPTANCE_CELLS = vm["delayed_acceptance_cells"].as<size_t>();
+	APPROXIMATE_REPLICAS_CELLS = vm["approximate_replicas_cells"].as<size_t>();
+	EXACT_REPLICAS = std::max((size_t)1, vm["exact_replicas"].as<size_t>());
+	MOVE_TYPE_ADAPTATION_STEPS = vm["move_type_adaptation_steps"].as<size_t>();
+	INFORMED_LABEL_PROPOSALS = vm["informed_label_proposals"].as<bool>();
+	INFORMED_REATTACHMENT = vm["informed_reattachment"].as<bool>();
+	MAX_EVENT_LOCI = vm["max_event_loci"].as<size_t>();
+	MAX_EVENT_LENGTH = vm["max_event_length"].as<double>();
     VERBOSE = vm["verbose"].as<bool>();
     NEUTRAL_CN = vm["neutral_cn"].as<double>();
 
-	Random<double> random(SEED);
-    CONETInputData<double> provider = create_from_file(string(data_dir).append("ratios"), string(data_dir).append("counts"), string(data_dir).append("counts_squared"), ';');
-    
-    log("Input files have been loaded successfully");
-    ParallelTemperingCoordinator<double> PT(provider, random);
-	CONETInferenceResult<double> result = PT.simulate(param_inf_iters, pt_inf_iters);
-	log("Tree inference has finished");
-
-	std::ofstream tree_file{ string(output_dir).append("inferred_tree") };
-	tree_file << TreeFormatter::to_string_representation(result.tree);
-
-	std::ofstream attachment_file{ string(output_dir).append("inferred_attachment") };
-	attachment_file << result.attachment;
+	auto precision = vm["precision"].as<string>();
+	if (precision == "double") {
+		run_inference<double>(data_dir, output_dir, param_inf_iters, pt_inf_iters);
+	} else if (precision == "float") {
+		run_inference<float>(data_dir, output_dir, param_inf_iters, pt_inf_iters);
+	} else {
+		log("Unknown precision: ", precision);
+		return 1;
+	}
     return 0;
 }
@@ -12,6 +12,16 @@ public:
 
   CONETInferenceResult<Real_t>(EventTree t, Attachment a, Real_t likelihood)
       : tree{t}, attachment{a}, likelihood{likelihood} {}
+
+  /**
+   * Overwrites the result with copies of @t and @a, reusing memory of the
+   * stored tree and attachment.
+   */
+  void assign(const EventTree &t, const Attachment &a, Real_t l) {
+    tree = t;
+    attachment = a;
+    likelihood = l;
+  }
 };
 
 #endif
\ No newline at end of file
@@ -61,30 +61,52 @@ std::vector<size_t> get_chromosome_markers(std::vector<double> chromosomes) {
 	return result;
 }
 
-CONETInputData<double> diff_matrix_to_cell_provider(std::vector<std::vector<double>> data) {
+template <class Real_t>
+std::vector<Real_t> convert_vector(const std::vector<double> &data) {
+	return std::vector<Real_t>(data.begin(), data.end());
+}
+
+template <class Real_t>
+std::vector<std::vector<Real_t>> convert_matrix(const std::vector<std::vector<double>> &data) {
+	std::vector<std::vector<Real_t>> result;
+	for (auto &row : data) {
+		result.push_back(convert_vector<Real_t>(row));
+	}
+	return result;
+}
+
+template <class Real_t>
+CONETInputData<Real_t> diff_matrix_to_cell_provider(std::vector<std::vector<double>> data) {
 	const size_t CHROMOSOME_ROW = 0;
 	const size_t BETWEEN_BINS_LENGTH_ROW = 1;
 	const size_t DIFFS_START_ROW = 2;
 
-	CONETInputData<double> provider(data[0].size(), get_chromosome_markers(data[CHROMOSOME_ROW]), data[BETWEEN_BINS_LENGTH_ROW]);
+	CONETInputData<Real_t> provider(data[0].size(), get_chromosome_markers(data[CHROMOSOME_ROW]), convert_vector<Real_t>(data[BETWEEN_BINS_LENGTH_ROW]));
+	provider.reserve_cells(data.size() - DIFFS_START_ROW);
 	for (size_t i = DIFFS_START_ROW; i < data.size(); i++) {
 		std::for_each(data[i].begin(), data[i].end(), [](double &r){r = -std::abs(r);});  
-		provider.post_cell(data[i]);
+		auto cell = convert_vector<Real_t>(data[i]);
+		provider.post_cell(cell);
 	}
 	return provider;
 }
 
-void read_counts_penalty_files(CONETInputData<double> &provider, std::string summed_counts_path, std::string squared_counts_path, char delimiter) {
-	auto summed_counts = string_matrix_to_double(split_file_by_delimiter(summed_counts_path, delimiter));
-	auto squared_counts = string_matrix_to_double(split_file_by_delimiter(squared_counts_path, delimiter));
+template <class Real_t>
+void read_counts_penalty_files(CONETInputData<Real_t> &provider, std::string summed_counts_path, std::string squared_counts_path, char delimiter) {
+	auto summed_counts = convert_matrix<Real_t>(string_matrix_to_double(split_file_by_delimiter(summed_counts_path, delimiter)));
+	auto squared_counts = convert_matrix<Real_t>(string_matrix_to_double(split_file_by_delimiter(squared_counts_path, delimiter)));
 	auto regions_sizes = summed_counts[0];
 	summed_counts.erase(summed_counts.begin());
 	squared_counts.erase(squared_counts.begin());
 	provider.post_counts_dispersion_data(regions_sizes, summed_counts, squared_counts);
 }
 
-CONETInputData<double> create_from_file(std::string path, std::string summed_counts_path, std::string squared_counts_path, char delimiter) {
-	CONETInputData<double> provider = diff_matrix_to_cell_provider(string_matrix_to_double(split_file_by_delimiter(path, delimiter)));
+template <class Real_t>
+CONETInputData<Real_t> create_from_file(std::string path, std::string summed_counts_path, std::string squared_counts_path, char delimiter) {
+	CONETInputData<Real_t> provider = diff_matrix_to_cell_provider<Real_t>(string_matrix_to_double(split_file_by_delimiter(path, delimiter)));
 	read_counts_penalty_files(provider, summed_counts_path, squared_counts_path, delimiter);
 	return provider;
 }
+
+template CONETInputData<double> create_from_file<double>(std::string path, std::string summed_counts_path, std::string squared_counts_path, char delimiter);
+template CONETInputData<float> create_from_file<float>(std::string path, std::string summed_counts_path, std::string squared_counts_path, char delimiter);
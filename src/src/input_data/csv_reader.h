@@ -2,7 +2,12 @@
 #define CSV_READER_H
 #include "input_data.h"
 
-CONETInputData<double> create_from_file(std::string path,
+/**
+ * Values are parsed in double precision and converted to @Real_t.
+ * Instantiated for double and float.
+ */
+template <class Real_t>
+CONETInputData<Real_t> create_from_file(std::string path,
                                         std::string summed_counts_path,
                                         std::string squared_counts_path,
                                         char delimiter);
@@ -1,9 +1,9 @@
 #ifndef VECTOR_CELL_PROVIDER_H
 #define VECTOR_CELL_PROVIDER_H
-#include <numeric>
 #include <vector>
 
 #include "../types.h"
+#include "../utils/dense_matrix.h"
 
 /**
  * Container for CONET input data
@@ -14,12 +14,14 @@ template <class Real_t> class CONETInputData {
 private:
   const size_t loci_count;
   size_t cell_count{0};
-  std::vector<std::vector<Real_t>> corrected_counts{loci_count};
+  DenseMatrix<Real_t> corrected_counts{loci_count, 0};
+  std::vector<Real_t> between_bins_lengths;
   /**
    * For pair of breakpoints (br1, br2) length of event (br1, br2)
-   * is equal to eventLengths[br1] - eventLengths[br2]
+   * is equal to cumulative_lengths[br2] - cumulative_lengths[br1]. Sums are
+   * kept in double precision, also when lengths are stored in floats.
    */
-  std::vector<Real_t> between_bins_lengths;
+  std::vector<double> cumulative_lengths;
   /**
    * Contains indices of first breakpoint from each chromosome (expcept for the
    * first one) and loci_count as a last element;
@@ -39,11 +41,24 @@ public:
   CONETInputData(size_t loci_count, std::vector<size_t> chrom_m,
                  std::vector<Real_t> between)
       : loci_count{loci_count}, chromosome_markers{chrom_m},
-        between_bins_lengths{between} {}
+        between_bins_lengths{between} {
+    cumulative_lengths.reserve(between_bins_lengths.size() + 1);
+    cumulative_lengths.push_back(0.0);
+    for (auto length : between_bins_lengths) {
+      cumulative_lengths.push_back(cumulative_lengths.back() + length);
+    }
+  }
+
+  /**
+   * Makes room for @cells cells in total, so that posting them does not
+   * copy the counts already posted.
+   */
+  void reserve_cells(size_t cells) { corrected_counts.reserve_columns(cells); }
 
   void post_cell(std::vector<Real_t> &cell) {
+    corrected_counts.resize_columns(cell_count + 1);
     for (size_t i = 0; i < cell.size(); i++) {
-      corrected_counts[i].push_back(cell[i]);
+      corrected_counts[i][cell_count] = cell[i];
     }
     cell_count++;
   }
@@ -72,18 +87,42 @@ public:
     return this->chromosome_markers;
   }
 
-  const std::vector<std::vector<Real_t>> &get_corrected_counts() const {
+  const DenseMatrix<Real_t> &get_corrected_counts() const {
     return corrected_counts;
   }
 
   size_t get_cells_count() const { return cell_count; }
 
+  /**
+   * Returns input data restricted to cells @cells, in the given order.
+   */
+  CONETInputData<Real_t>
+  get_cells_subset(const std::vector<size_t> &cells) const {
+    CONETInputData<Real_t> subset(loci_count, chromosome_markers,
+                                  between_bins_lengths);
+    std::vector<Real_t> cell(loci_count);
+    std::vector<std::vector<Real_t>> subset_summed_counts;
+    std::vector<std::vector<Real_t>> subset_squared_counts;
+    subset.reserve_cells(cells.size());
+    for (auto c : cells) {
+      for (size_t i = 0; i < loci_count; i++) {
+        cell[i] = corrected_counts[i][c];
+      }
+      subset.post_cell(cell);
+      subset_summed_counts.push_back(summed_counts[c]);
+      subset_squared_counts.push_back(squared_counts[c]);
+    }
+    auto regions = counts_scores_regions;
+    subset.post_counts_dispersion_data(regions, subset_summed_counts,
+                                       subset_squared_counts);
+    return subset;
+  }
+
   size_t get_loci_count() const { return loci_count; }
 
   Real_t get_event_length(Event event) const {
-    return std::accumulate(
-        between_bins_lengths.begin() + get_event_start_locus(event),
-        between_bins_lengths.begin() + get_event_end_locus(event), (Real_t)0.0);
+    return cumulative_lengths[get_event_end_locus(event)] -
+           cumulative_lengths[get_event_start_locus(event)];
   }
 };
 #endif // !VECTOR_CELL_PROVIDER_H
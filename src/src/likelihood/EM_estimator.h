@@ -26,9 +26,9 @@ template <class Real_t> class EMEstimator {
 
   std::vector<std::vector<Real_t>> get_component_membership_weights() {
     std::vector<std::vector<Real_t>> result =
-        Matrix::create_2d_matrix(means.size(), data.size(), 0.0);
+        Matrix::create_2d_matrix(means.size(), data.size(), (Real_t)0.0);
     std::vector<Real_t> densities_sums =
-        Matrix::create_1d_matrix(data.size(), 0.0);
+        Matrix::create_1d_matrix(data.size(), (Real_t)0.0);
 
     for (size_t component = 0; component < means.size(); component++) {
       for (size_t arg = 0; arg < data.size(); arg++) {
@@ -1,9 +1,11 @@
 #ifndef GAUSSIAN_H
 #define GAUSSIAN_H
+#include <sstream>
 #include <thread>
 #include <utility>
 
 #include "../parameters/parameters.h"
+#include "../utils/dense_matrix.h"
 #include "../utils/random.h"
 #include "adaptive_mh.h"
 #include "gaussian_utils.h"
@@ -20,18 +22,18 @@ private:
   AdaptiveMH<Real_t> adaptive_rw_var_variance;
 
   void fill_log_likelihood_matrix_parallelized(
-      std::vector<std::vector<Real_t>> &matrix,
-      const std::vector<std::vector<Real_t>> &sample) const {
+      DenseMatrix<Real_t> &matrix, const DenseMatrix<Real_t> &sample) const {
     std::vector<std::thread> threads;
-    size_t rows_per_thread = matrix.size() / THREADS_LIKELIHOOD;
+    size_t rows_per_thread = matrix.rows() / THREADS_LIKELIHOOD;
     for (size_t th = 0; th < THREADS_LIKELIHOOD; th++) {
-      size_t right = th == THREADS_LIKELIHOOD - 1 ? matrix.size()
+      size_t right = th == THREADS_LIKELIHOOD - 1 ? matrix.rows()
                                                   : rows_per_thread * (th + 1);
       threads.emplace_back(
           [&matrix, &sample, th, rows_per_thread, right, this] {
             for (size_t c = rows_per_thread * th; c < right; c++) {
-              Gauss::truncated_gaussian_log_likelihood(matrix[c], sample[c],
-                                                       this->mean, this->sd);
+              Gauss::truncated_gaussian_log_likelihood(
+                  matrix[c], sample[c], matrix.columns(), this->mean,
+                  this->sd);
             }
           });
     }
@@ -52,14 +54,13 @@ public:
   }
 
   void fill_log_likelihood_matrix(
-      std::vector<std::vector<Real_t>> &matrix,
-      const std::vector<std::vector<Real_t>> &sample) const {
+      DenseMatrix<Real_t> &matrix, const DenseMatrix<Real_t> &sample) const {
     if (THREADS_LIKELIHOOD > 1) {
       fill_log_likelihood_matrix_parallelized(matrix, sample);
     } else {
-      for (size_t c = 0; c < matrix.size(); c++) {
-        Gauss::truncated_gaussian_log_likelihood(matrix[c], sample[c], mean,
-                                                 sd);
+      for (size_t c = 0; c < matrix.rows(); c++) {
+        Gauss::truncated_gaussian_log_likelihood(matrix[c], sample[c],
+                                                 matrix.columns(), mean, sd);
       }
     }
   }
@@ -6,6 +6,7 @@
 #include <sstream>
 
 #include "../parameters/parameters.h"
+#include "../utils/dense_matrix.h"
 #include "../utils/log_sum_accumulator.h"
 #include "../utils/matrix.h"
 #include "../utils/random.h"
@@ -23,21 +24,17 @@ template <class Real_t> class GaussianMixture {
   std::vector<AdaptiveMH<Real_t>> rw_step_size_variances;
   Random<Real_t> &random;
 
-  void fill_log_likelihood_matrix(std::vector<Real_t> &matrix,
-                                  const std::vector<Real_t> &sample) const {
-    std::vector<LogWeightAccumulator<Real_t>> acc(sample.size());
+  void fill_log_likelihood_row(Real_t *matrix, const Real_t *sample,
+                               const size_t size) const {
+    LogWeightAccumulators<Real_t> acc(size);
 
     for (size_t component = 0; component < components.size(); component++) {
-      Gauss::truncated_gaussian_log_likelihood(
-          matrix, sample, components[component].mean, components[component].sd);
-      const Real_t weight = log_normalized_weights[component];
-      for (size_t i = 0; i < sample.size(); i++) {
-        acc[i].add(matrix[i] + weight);
-      }
-    }
-    for (size_t i = 0; i < sample.size(); i++) {
-      matrix[i] = acc[i].get_result();
+      Gauss::truncated_gaussian_log_likelihood(matrix, sample, size,
+                                               components[component].mean,
+                                               components[component].sd);
+      acc.add(matrix, log_normalized_weights[component]);
     }
+    acc.get_results(matrix);
   }
 
   void recalculate_log_normalized_weights() {
@@ -55,17 +52,17 @@ template <class Real_t> class GaussianMixture {
   }
 
   void fill_log_likelihood_matrix_parallelized(
-      std::vector<std::vector<Real_t>> &matrix,
-      const std::vector<std::vector<Real_t>> &sample) const {
+      DenseMatrix<Real_t> &matrix, const DenseMatrix<Real_t> &sample) const {
     std::vector<std::thread> threads;
-    size_t rows_per_thread = matrix.size() / THREADS_LIKELIHOOD;
+    size_t rows_per_thread = matrix.rows() / THREADS_LIKELIHOOD;
     for (size_t th = 0; th < THREADS_LIKELIHOOD; th++) {
-      size_t right = th == THREADS_LIKELIHOOD - 1 ? matrix.size()
+      size_t right = th == THREADS_LIKELIHOOD - 1 ? matrix.rows()
                                                   : rows_per_thread * (th + 1);
       threads.emplace_back(
           [&matrix, &sample, th, rows_per_thread, right, this] {
             for (size_t c = rows_per_thread * th; c < right; c++) {
-              this->fill_log_likelihood_matrix(matrix[c], sample[c]);
+              this->fill_log_likelihood_row(matrix[c], sample[c],
+                                            matrix.columns());
             }
           });
     }
@@ -150,13 +147,12 @@ public:
   }
 
   void fill_log_likelihood_matrix(
-      std::vector<std::vector<Real_t>> &matrix,
-      const std::vector<std::vector<Real_t>> &sample) const {
+      DenseMatrix<Real_t> &matrix, const DenseMatrix<Real_t> &sample) const {
     if (THREADS_LIKELIHOOD > 1) {
       fill_log_likelihood_matrix_parallelized(matrix, sample);
     } else {
-      for (size_t c = 0; c < matrix.size(); c++) {
-        fill_log_likelihood_matrix(matrix[c], sample[c]);
+      for (size_t c = 0; c < matrix.rows(); c++) {
+        fill_log_likelihood_row(matrix[c], sample[c], matrix.columns());
       }
     }
   }
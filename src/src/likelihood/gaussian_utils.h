@@ -24,14 +24,14 @@ Real_t gaussian_CDF(const Real_t x, const Real_t mean,
 }
 
 template <class Real_t>
-void truncated_gaussian_log_likelihood(std::vector<Real_t> &result,
-                                       const std::vector<Real_t> &args,
-                                       const Real_t mean, const Real_t sd) {
+void truncated_gaussian_log_likelihood(Real_t *result, const Real_t *args,
+                                       const size_t size, const Real_t mean,
+                                       const Real_t sd) {
   const Real_t log_inv_sqrt_2pi = -0.9189385;
   const Real_t log_sd = std::log(sd);
   Real_t correction = std::log(gaussian_CDF<Real_t>(0.0, mean, sd));
 
-  for (size_t i = 0; i < args.size(); i++) {
+  for (size_t i = 0; i < size; i++) {
     Real_t res = -0.5 * (args[i] - mean) * (args[i] - mean) / (sd * sd);
     result[i] = log_inv_sqrt_2pi - log_sd + res - correction;
   }
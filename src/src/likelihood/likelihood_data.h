@@ -19,14 +19,14 @@ public:
       : no_brkp_likelihood{noBrkp}, brkp_likelihood{mxt} {}
 
   void fill_no_breakpoint_log_likelihood_matrix(
-      std::vector<std::vector<Real_t>> &matrix,
-      const std::vector<std::vector<Real_t>> &corrected_counts) const {
+      DenseMatrix<Real_t> &matrix,
+      const DenseMatrix<Real_t> &corrected_counts) const {
     no_brkp_likelihood.fill_log_likelihood_matrix(matrix, corrected_counts);
   }
 
   void fill_breakpoint_log_likelihood_matrix(
-      std::vector<std::vector<Real_t>> &matrix,
-      const std::vector<std::vector<Real_t>> &corrected_counts) const {
+      DenseMatrix<Real_t> &matrix,
+      const DenseMatrix<Real_t> &corrected_counts) const {
     brkp_likelihood.fill_log_likelihood_matrix(matrix, corrected_counts);
   }
 
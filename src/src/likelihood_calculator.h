@@ -1,33 +1,71 @@
 #ifndef LIK_CALC___H
 #define LIK_CALC___H
 #include <algorithm>
+#include <cmath>
 #include <map>
 #include <numeric>
-#include <thread>
+#include <type_traits>
 
 #include "input_data/input_data.h"
 #include "parameters/parameters.h"
 #include "tree/attachment.h"
 #include "tree/event_tree.h"
+#include "utils/dense_matrix.h"
 #include "utils/log_sum_accumulator.h"
-#include "utils/matrix.h"
+#include "utils/simd_kernels.h"
+#include "utils/thread_pool.h"
 
+/**
+ * Per cell log-sum-exp and the sum of cell likelihoods are calculated in
+ * double precision, also when likelihoods are stored in floats.
+ */
+using LikelihoodSum_t = double;
+
+/**
+ * Log-likelihoods of corrected counts for each (locus, cell) pair.
+ *
+ * Tree traversal only needs the difference between breakpoint and
+ * no-breakpoint log-likelihoods, so breakpoint likelihoods are kept only as
+ * @breakpoint_delta. No-breakpoint likelihoods are needed only for
+ * @root_likelihoods, which do not depend on the tree.
+ */
 template <class Real_t> class LikelihoodMatrices {
 public:
-  std::vector<std::vector<Real_t>> breakpoint_likelihoods;
-  std::vector<std::vector<Real_t>> no_breakpoint_likelihoods;
+  DenseMatrix<Real_t> breakpoint_delta;
+  DenseMatrix<Real_t> no_breakpoint_likelihoods;
+  // Log-likelihood of each cell attached to the root - sum of columns of
+  // @no_breakpoint_likelihoods
+  AlignedVector<Real_t> root_likelihoods;
+
+  LikelihoodMatrices<Real_t>(size_t bins, size_t cells)
+      : breakpoint_delta{bins, cells}, no_breakpoint_likelihoods{bins, cells},
+        root_likelihoods(cells) {}
 
-  LikelihoodMatrices<Real_t>(size_t bins, size_t cells) {
-    this->breakpoint_likelihoods =
-        Matrix::create_2d_matrix<Real_t>(bins, cells, 0.0);
-    this->no_breakpoint_likelihoods =
-        Matrix::create_2d_matrix<Real_t>(bins, cells, 0.0);
+  void calculate_root_likelihoods() {
+    std::fill(root_likelihoods.begin(), root_likelihoods.end(), 0.0);
+    for (size_t bin = 0; bin < no_breakpoint_likelihoods.rows(); bin++) {
+      Simd::add(root_likelihoods.data(), no_breakpoint_likelihoods[bin],
+                root_likelihoods.size());
+    }
+  }
+
+  /**
+   * Turns @breakpoint_delta filled with breakpoint log-likelihoods into
+   * difference between breakpoint and no-breakpoint log-likelihoods.
+   */
+  void calculate_breakpoint_delta() {
+    for (size_t bin = 0; bin < breakpoint_delta.rows(); bin++) {
+      Simd::subtract(breakpoint_delta[bin], no_breakpoint_likelihoods[bin],
+                     breakpoint_delta.columns());
+    }
   }
 
   static void swap(LikelihoodMatrices<Real_t> &m1,
                    LikelihoodMatrices<Real_t> &m2) {
-    std::swap(m1.breakpoint_likelihoods, m2.breakpoint_likelihoods);
-    std::swap(m1.no_breakpoint_likelihoods, m2.no_breakpoint_likelihoods);
+    DenseMatrix<Real_t>::swap(m1.breakpoint_delta, m2.breakpoint_delta);
+    DenseMatrix<Real_t>::swap(m1.no_breakpoint_likelihoods,
+                              m2.no_breakpoint_likelihoods);
+    std::swap(m1.root_likelihoods, m2.root_likelihoods);
   }
 };
 
@@ -36,172 +74,571 @@ private:
   using NodeHandle = EventTree::NodeHandle;
 
 public:
-  std::vector<LogWeightAccumulator<Real_t>> likelihood_result;
-  std::vector<Real_t> root_likelihoods;
-  std::vector<Real_t> cell_to_max_attachment_likelihood;
+  LogWeightAccumulators<LikelihoodSum_t> likelihood_result;
+  AlignedVector<Real_t> cell_to_max_attachment_likelihood;
+  // Position of the max attachment node in the depth first order of the tree
+  AlignedVector<Real_t> cell_to_max_attachment_position;
+  std::vector<size_t> cell_to_max_attachment_node;
   Attachment max_attachment;
-  std::map<Event, Real_t> events_lengths;
   Real_t likelihood;
 
   LikelihoodCalculatorState<Real_t>(size_t cells_count)
-      : max_attachment{get_root_label(), cells_count} {
-    likelihood_result.resize(cells_count);
-    root_likelihoods.resize(cells_count);
+      : likelihood_result{cells_count},
+        max_attachment{get_root_label(), cells_count} {
     cell_to_max_attachment_likelihood.resize(cells_count);
+    cell_to_max_attachment_position.resize(cells_count);
+    cell_to_max_attachment_node.resize(cells_count);
   }
 
   static void swap(LikelihoodCalculatorState<Real_t> &s1,
                    LikelihoodCalculatorState<Real_t> &s2) {
     std::swap(s1.likelihood_result, s2.likelihood_result);
-    std::swap(s1.root_likelihoods, s2.root_likelihoods);
     std::swap(s1.cell_to_max_attachment_likelihood,
               s2.cell_to_max_attachment_likelihood);
+    std::swap(s1.cell_to_max_attachment_position,
+              s2.cell_to_max_attachment_position);
+    std::swap(s1.cell_to_max_attachment_node, s2.cell_to_max_attachment_node);
     std::swap(s1.max_attachment, s2.max_attachment);
-    std::swap(s1.events_lengths, s2.events_lengths);
     std::swap(s1.likelihood, s2.likelihood);
   }
 };
 
+/**
+ * Likelihood data of a single tree node.
+ *
+ * Path likelihoods of a node depend only on labels of the nodes on its path
+ * from the root, so the record stays valid as long as node's label and parent
+ * are unchanged and the record of the parent is valid.
+ */
+template <class Real_t> class NodeLikelihoodRecord {
+public:
+  EventTree::NodeHandle parent{EventTree::NULL_NODE};
+  TreeLabel label;
+  size_t depth{0};
+  // Summed length of events on the path from the root
+  Real_t events_length{0.0};
+  // Unnormalized log probability of cell attachment to the node
+  Real_t attachment_log_prior{0.0};
+  // Log-likelihood of each cell under the assumption that it is attached to
+  // the node
+  AlignedVector<Real_t> path_likelihoods;
+  // Position of the node in the depth first order of the last scored tree
+  size_t position{0};
+  size_t validation_mark{0};
+  bool exists{false};
+};
+
+/**
+ * Persistent per node likelihood data, indexed by node ids.
+ *
+ * Committed records correspond to the last persisted tree, pending records
+ * contain data of nodes which have been created or changed in the last scored
+ * tree. Scoring of a tree recalculates only pending records, persisting the
+ * result merges them into committed ones. Discarding the result is free.
+ */
+template <class Real_t> class NodeLikelihoodCache {
+  using NodeHandle = EventTree::NodeHandle;
+  using Records = std::vector<NodeLikelihoodRecord<Real_t>>;
+
+  /**
+   * Incremental updates of per cell accumulators accumulate rounding errors,
+   * so every now and then all records are calculated from scratch.
+   */
+  const size_t FULL_RECALCULATION_FREQUENCY = 10000;
+
+  bool full_recalculation_requested{true};
+  size_t commits_since_full_recalculation{0};
+  // True if the last full recalculation was due to FULL_RECALCULATION_FREQUENCY
+  bool last_calculation_periodic{false};
+
+  void discard_committed_record(size_t id) {
+    spare_rows.push_back(std::move(committed[id].path_likelihoods));
+    committed[id].exists = false;
+  }
+
+public:
+  Records committed;
+  Records pending;
+  std::vector<char> is_pending;
+  // Ids of all nodes of the last persisted tree in depth first order
+  std::vector<size_t> committed_order;
+  // Ids of all nodes of the last scored tree in depth first order
+  std::vector<size_t> order;
+  // Ids of pending nodes in depth first order
+  std::vector<size_t> pending_order;
+  // Pending nodes in depth first order, valid only until the tree is modified
+  std::vector<NodeHandle> pending_nodes;
+  // Ids of committed records which are not valid for the last scored tree
+  std::vector<size_t> stale;
+  bool last_calculation_full{false};
+  size_t validation_mark{0};
+  std::vector<AlignedVector<Real_t>> spare_rows;
+  // Records of the last scored tree in depth first order
+  std::vector<NodeLikelihoodRecord<Real_t> *> ordered_records;
+  // Cell flags are written concurrently, so std::vector<bool> can't be used
+  std::vector<char> cells_to_refill;
+  std::vector<char> cells_to_reattach;
+  AlignedVector<LikelihoodSum_t> cell_likelihoods;
+  // Cells whose max attachment has changed, per task of the last scoring
+  std::vector<std::vector<size_t>> changed_attachments;
+
+  NodeLikelihoodCache(size_t cells_count)
+      : cells_to_refill(cells_count, false),
+        cells_to_reattach(cells_count, false), cell_likelihoods(cells_count) {}
+
+  void request_full_recalculation() { full_recalculation_requested = true; }
+
+  /**
+   * Prepares cache for scoring of a new tree, whose node ids are smaller than
+   * @node_id_bound. Returns true if all records should be calculated from
+   * scratch.
+   */
+  bool start_calculation(size_t node_id_bound) {
+    for (auto id : pending_order) {
+      spare_rows.push_back(std::move(pending[id].path_likelihoods));
+      is_pending[id] = false;
+    }
+    if (committed.size() < node_id_bound) {
+      committed.resize(node_id_bound);
+      pending.resize(node_id_bound);
+      is_pending.resize(node_id_bound, false);
+    }
+    pending_order.clear();
+    pending_nodes.clear();
+    stale.clear();
+    order.clear();
+    ordered_records.clear();
+    validation_mark++;
+    last_calculation_periodic =
+        !full_recalculation_requested &&
+        commits_since_full_recalculation >= FULL_RECALCULATION_FREQUENCY;
+    last_calculation_full =
+        full_recalculation_requested || last_calculation_periodic;
+    full_recalculation_requested = false;
+    return last_calculation_full;
+  }
+
+  bool is_last_calculation_periodic() const {
+    return last_calculation_periodic;
+  }
+
+  AlignedVector<Real_t> get_row(size_t cells_count) {
+    if (spare_rows.empty()) {
+      return AlignedVector<Real_t>(cells_count);
+    }
+    auto row = std::move(spare_rows.back());
+    spare_rows.pop_back();
+    return row;
+  }
+
+  NodeLikelihoodRecord<Real_t> &get_record(size_t id) {
+    return is_pending[id] ? pending[id] : committed[id];
+  }
+
+  void commit() {
+    if (last_calculation_full) {
+      for (auto id : committed_order) {
+        discard_committed_record(id);
+      }
+      commits_since_full_recalculation = 0;
+    } else {
+      for (auto id : stale) {
+        discard_committed_record(id);
+      }
+      commits_since_full_recalculation++;
+    }
+    for (auto id : pending_order) {
+      committed[id] = std::move(pending[id]);
+      is_pending[id] = false;
+    }
+    pending_order.clear();
+    pending_nodes.clear();
+    stale.clear();
+    std::swap(committed_order, order);
+    last_calculation_full = false;
+  }
+};
+
+/**
+ * Calculates likelihood of the tree incrementally.
+ *
+ * Only nodes whose path from the root has changed since the last persisted
+ * calculation are scored, per cell accumulators are patched by removing
+ * contributions of stale nodes and adding contributions of the new ones.
+ *
+ * Tree structure is processed sequentially, per cell data is processed in
+ * contiguous cell ranges on @thread_pool. Cell likelihoods are summed up in
+ * a fixed order, so the result does not depend on the number of threads.
+ */
 template <class Real_t> class LikelihoodCalculator {
+  /**
+   * Smaller cell ranges are not worth synchronization of threads.
+   */
+  static const size_t MIN_CELLS_PER_TASK = 256;
+
   EventTree &tree;
+  const LikelihoodCalculatorState<Real_t> &persisted_state;
   LikelihoodCalculatorState<Real_t> &state;
+  NodeLikelihoodCache<Real_t> &cache;
   CONETInputData<Real_t> &cells;
-  LikelihoodMatrices<Real_t> &likelihood_matrices;
+  const LikelihoodMatrices<Real_t> &likelihood_matrices;
+  ThreadPool &thread_pool;
 
   using NodeHandle = EventTree::NodeHandle;
 
-  void get_normalized_event_lengths(NodeHandle node, Real_t length,
-                                    Real_t depth) {
-    state.events_lengths[tree.get_node_event(node)] = 0.0;
+
+  /**
+   * Sets @likelihood to @parent_likelihood extended by new breakpoints of
+   * @node, for cells from [@begin, @end).
+   */
+  void extend_likelihood_to_node(NodeHandle node,
+                                 const AlignedVector<Real_t> &parent_likelihood,
+                                 AlignedVector<Real_t> &likelihood,
+                                 size_t begin, size_t end) {
+    auto &delta = likelihood_matrices.breakpoint_delta;
+    auto breakpoints = tree.get_new_breakpoints(node);
+    if (breakpoints.empty()) {
+      std::copy(parent_likelihood.begin() + begin,
+                parent_likelihood.begin() + end, likelihood.begin() + begin);
+      return;
+    }
+    auto br = breakpoints.begin();
+    Simd::add_rows(likelihood.data() + begin, parent_likelihood.data() + begin,
+                   delta[*br] + begin, end - begin);
+    for (br++; br != breakpoints.end(); br++) {
+      Simd::add(likelihood.data() + begin, delta[*br] + begin, end - begin);
+    }
+  }
+
+  bool record_is_valid(NodeHandle node) {
+    auto &record = cache.committed[tree.get_node_id(node)];
+    return record.exists && record.parent == tree.get_parent(node) &&
+           record.label == tree.get_node_label(node);
+  }
+
+  /**
+   * Creates pending record of @node. Its path likelihoods are calculated
+   * later, by @calculate_path_likelihoods.
+   */
+  void create_record(NodeHandle node) {
+    NodeLikelihoodRecord<Real_t> record;
+    record.exists = true;
+    record.parent = tree.get_parent(node);
+    record.label = tree.get_node_label(node);
+    record.path_likelihoods = cache.get_row(cells.get_cells_count());
     if (node != tree.get_root()) {
-      length += cells.get_event_length(node->label);
-      state.events_lengths[tree.get_node_event(node)] = length / depth;
+      auto &parent_record = cache.get_record(tree.get_node_id(record.parent));
+      record.depth = parent_record.depth + 1;
+      record.events_length =
+          parent_record.events_length + cells.get_event_length(record.label);
+      if (USE_EVENT_LENGTHS_IN_ATTACHMENT) {
+        record.attachment_log_prior =
+            -record.events_length / (Real_t)record.depth;
+      }
     }
+    const size_t id = tree.get_node_id(node);
+    cache.pending[id] = std::move(record);
+    cache.is_pending[id] = true;
+    cache.pending_order.push_back(id);
+    cache.pending_nodes.push_back(node);
+  }
 
+  /**
+   * Depth first traversal which reuses valid committed records and creates
+   * pending records for all other nodes.
+   */
+  void update_records(NodeHandle node, bool parent_valid) {
+    const bool valid = parent_valid && record_is_valid(node);
+    const size_t id = tree.get_node_id(node);
+    if (valid) {
+      cache.committed[id].validation_mark = cache.validation_mark;
+    } else {
+      create_record(node);
+    }
+    auto &record = cache.get_record(id);
+    record.position = cache.order.size();
+    cache.order.push_back(id);
+    cache.ordered_records.push_back(&record);
     for (auto child : tree.get_children(node)) {
-      get_normalized_event_lengths(child, length, depth + 1);
+      update_records(child, valid);
     }
   }
 
-  void recalculate_event_lengths() {
-    state.events_lengths.clear();
-    get_normalized_event_lengths(tree.get_root(), 0.0, 0.0);
-    Real_t sum = std::accumulate(
-        state.events_lengths.begin(), state.events_lengths.end(), 0.0,
-        [](const Real_t previous, decltype(*state.events_lengths.begin()) p) {
-          return previous + std::exp(-p.second);
-        });
-    for (auto &el : state.events_lengths) {
-      el.second = -el.second - std::log(sum);
+  void find_stale_records() {
+    for (auto id : cache.committed_order) {
+      if (cache.committed[id].validation_mark != cache.validation_mark) {
+        cache.stale.push_back(id);
+      }
     }
   }
 
-  void calculate_root_likelihood() {
-    for (size_t c = 0; c < cells.get_cells_count(); c++) {
-      state.root_likelihoods[c] = 0.0;
-    }
-    for (size_t bin = 0;
-         bin < likelihood_matrices.no_breakpoint_likelihoods.size(); bin++) {
-      for (size_t c = 0; c < cells.get_cells_count(); c++) {
-        state.root_likelihoods[c] +=
-            likelihood_matrices.no_breakpoint_likelihoods[bin][c];
+  void calculate_path_likelihoods(size_t begin, size_t end) {
+    for (size_t i = 0; i < cache.pending_order.size(); i++) {
+      auto node = cache.pending_nodes[i];
+      auto &record = cache.pending[cache.pending_order[i]];
+      if (node == tree.get_root()) {
+        auto &root_likelihoods = likelihood_matrices.root_likelihoods;
+        std::copy(root_likelihoods.begin() + begin,
+                  root_likelihoods.begin() + end,
+                  record.path_likelihoods.begin() + begin);
+      } else {
+        extend_likelihood_to_node(
+            node,
+            cache.get_record(tree.get_node_id(record.parent)).path_likelihoods,
+            record.path_likelihoods, begin, end);
       }
     }
   }
 
-  void extend_likelihood_to_node(NodeHandle node,
-                                 std::vector<Real_t> &parent_likelihood) {
-    auto breakpoints = tree.get_new_breakpoints(node);
-    for (auto br : breakpoints) {
-      for (size_t c = 0; c < cells.get_cells_count(); c++) {
-        parent_likelihood[c] +=
-            likelihood_matrices.breakpoint_likelihoods[br][c] -
-            likelihood_matrices.no_breakpoint_likelihoods[br][c];
+  void attach_to_root(size_t cell) {
+    state.cell_to_max_attachment_likelihood[cell] =
+        cache.ordered_records[0]->path_likelihoods[cell];
+    state.cell_to_max_attachment_position[cell] = 0.0;
+  }
+
+  void reset_cell_data(size_t begin, size_t end) {
+    state.likelihood_result.clear(begin, end);
+    for (size_t c = begin; c < end; c++) {
+      attach_to_root(c);
+    }
+  }
+
+  void copy_persisted_cell_data(size_t begin, size_t end) {
+    state.likelihood_result.copy(persisted_state.likelihood_result, begin,
+                                 end);
+    std::copy(persisted_state.cell_to_max_attachment_likelihood.begin() + begin,
+              persisted_state.cell_to_max_attachment_likelihood.begin() + end,
+              state.cell_to_max_attachment_likelihood.begin() + begin);
+    std::copy(persisted_state.cell_to_max_attachment_node.begin() + begin,
+              persisted_state.cell_to_max_attachment_node.begin() + end,
+              state.cell_to_max_attachment_node.begin() + begin);
+  }
+
+  void remove_stale_contributions(size_t begin, size_t end) {
+    for (auto id : cache.stale) {
+      auto &record = cache.committed[id];
+      state.likelihood_result.remove(record.path_likelihoods.data(),
+                                     record.attachment_log_prior, begin, end);
+    }
+  }
+
+  /**
+   * Finds cells whose accumulators have been cancelled out by removals and
+   * cells whose max attachment node is stale. Max attachment nodes of other
+   * cells may have changed their positions in the depth first order.
+   */
+  void update_persisted_cell_data(size_t begin, size_t end) {
+    for (size_t c = begin; c < end; c++) {
+      cache.cells_to_refill[c] = state.likelihood_result.is_cancelled(c);
+      auto &record = cache.committed[state.cell_to_max_attachment_node[c]];
+      if (record.validation_mark != cache.validation_mark) {
+        cache.cells_to_reattach[c] = true;
+        attach_to_root(c);
+      } else {
+        state.cell_to_max_attachment_position[c] = record.position;
       }
     }
   }
 
-  void
-  reverse_likelihood_node_extension(NodeHandle node,
-                                    std::vector<Real_t> &parent_likelihood) {
-    auto breakpoints = tree.get_new_breakpoints(node);
-    for (auto br : breakpoints) {
-      for (size_t c = 0; c < cells.get_cells_count(); c++) {
-        parent_likelihood[c] +=
-            -likelihood_matrices.breakpoint_likelihoods[br][c] +
-            likelihood_matrices.no_breakpoint_likelihoods[br][c];
+  void add_pending_contributions(size_t begin, size_t end) {
+    for (size_t i = 0; i < cache.pending_order.size(); i++) {
+      if (cache.pending_nodes[i] == tree.get_root()) {
+        continue;
       }
+      auto &record = cache.pending[cache.pending_order[i]];
+      state.likelihood_result.add(record.path_likelihoods.data(),
+                                  record.attachment_log_prior, begin, end);
+      Simd::update_max(
+          state.cell_to_max_attachment_likelihood.data() + begin,
+          state.cell_to_max_attachment_position.data() + begin,
+          record.path_likelihoods.data() + begin, (Real_t)record.position,
+          end - begin);
     }
   }
 
-  void tree_depth_first_likelihood_calculation(
-      NodeHandle node, std::vector<Real_t> &parent_likelihood) {
-    extend_likelihood_to_node(node, parent_likelihood);
+  void recalculate_cell_from_scratch(size_t cell) {
+    if (cache.cells_to_refill[cell]) {
+      state.likelihood_result.clear(cell, cell + 1);
+    }
+    if (cache.cells_to_reattach[cell]) {
+      attach_to_root(cell);
+    }
+    for (size_t i = 1; i < cache.ordered_records.size(); i++) {
+      auto &record = *cache.ordered_records[i];
+      if (cache.cells_to_refill[cell]) {
+        state.likelihood_result.add(
+            cell, (LikelihoodSum_t)record.path_likelihoods[cell] +
+                      record.attachment_log_prior);
+      }
+      if (cache.cells_to_reattach[cell] &&
+          state.cell_to_max_attachment_likelihood[cell] <
+              record.path_likelihoods[cell]) {
+        state.cell_to_max_attachment_likelihood[cell] =
+            record.path_likelihoods[cell];
+        state.cell_to_max_attachment_position[cell] = record.position;
+      }
+    }
+    cache.cells_to_refill[cell] = false;
+    cache.cells_to_reattach[cell] = false;
+  }
 
-    for (size_t c = 0; c < cells.get_cells_count(); c++) {
-      if (USE_EVENT_LENGTHS_IN_ATTACHMENT) {
-        state.likelihood_result[c].add(
-            parent_likelihood[c] +
-            state.events_lengths[tree.get_node_event(node)]);
-      } else {
-        state.likelihood_result[c].add(parent_likelihood[c]);
+  /**
+   * Attachment index can't be updated concurrently, so cells whose max
+   * attachment has changed are only recorded in @changed, see
+   * apply_attachment_changes.
+   */
+  void update_max_attachment(size_t begin, size_t end,
+                             std::vector<size_t> &changed) {
+    for (size_t c = begin; c < end; c++) {
+      if (cache.cells_to_refill[c] || cache.cells_to_reattach[c]) {
+        recalculate_cell_from_scratch(c);
       }
-      if (state.cell_to_max_attachment_likelihood[c] < parent_likelihood[c]) {
-        state.cell_to_max_attachment_likelihood[c] = parent_likelihood[c];
-        state.max_attachment.set_attachment(c, tree.get_node_label(node));
+      const auto position = (size_t)state.cell_to_max_attachment_position[c];
+      state.cell_to_max_attachment_node[c] = cache.order[position];
+      if (state.max_attachment.get_node_id(c) != cache.order[position] ||
+          state.max_attachment.get_label(c) !=
+              cache.ordered_records[position]->label) {
+        changed.push_back(c);
       }
     }
-    for (auto ch : tree.get_children(node)) {
-      tree_depth_first_likelihood_calculation(ch, parent_likelihood);
+  }
+
+  void apply_attachment_changes() {
+    for (auto &changed : cache.changed_attachments) {
+      for (auto c : changed) {
+        const auto position =
+            (size_t)state.cell_to_max_attachment_position[c];
+        state.max_attachment.set_attachment(
+            c, cache.ordered_records[position]->label, cache.order[position]);
+      }
     }
-    reverse_likelihood_node_extension(node, parent_likelihood);
   }
 
-  Real_t sum_cell_likelihoods() {
-    Real_t result_ = 0.0;
-    if (!USE_EVENT_LENGTHS_IN_ATTACHMENT) {
-      std::for_each(state.likelihood_result.rbegin(),
-                    state.likelihood_result.rend(),
-                    [&](LogWeightAccumulator<Real_t> &acc) {
-                      result_ += acc.get_result() -
-                                 std::log((Real_t)(tree.get_size() - 1));
-                    });
+  void calculate_cell_range(size_t begin, size_t end, bool full_recalculation,
+                            std::vector<size_t> &changed_attachments) {
+    calculate_path_likelihoods(begin, end);
+    if (full_recalculation) {
+      reset_cell_data(begin, end);
     } else {
-      std::for_each(state.likelihood_result.rbegin(),
-                    state.likelihood_result.rend(),
-                    [&](LogWeightAccumulator<Real_t> &acc) {
-                      result_ += acc.get_result();
-                    });
+      copy_persisted_cell_data(begin, end);
+      remove_stale_contributions(begin, end);
+      update_persisted_cell_data(begin, end);
     }
-    return result_;
+    add_pending_contributions(begin, end);
+    update_max_attachment(begin, end, changed_attachments);
+    state.likelihood_result.get_results(cache.cell_likelihoods.data(), begin,
+                                        end);
   }
 
-public:
-  LikelihoodCalculator<Real_t>(EventTree &tree,
-                               LikelihoodCalculatorState<Real_t> &state,
-                               CONETInputData<Real_t> &cells,
-                               LikelihoodMatrices<Real_t> &matrices)
-      : tree{tree}, state{state}, cells{cells}, likelihood_matrices{matrices} {}
+  LikelihoodSum_t get_attachment_log_normalizer() {
+    if (!USE_EVENT_LENGTHS_IN_ATTACHMENT) {
+      return std::log((LikelihoodSum_t)(tree.get_size() - 1));
+    }
+    LogWeightAccumulator<LikelihoodSum_t> normalizer;
+    for (auto record : cache.ordered_records) {
+      normalizer.add(record->attachment_log_prior);
+    }
+    return normalizer.get_result();
+  }
 
-  Real_t calculate_likelihood() {
-    calculate_root_likelihood();
+  Real_t sum_cell_likelihoods() {
+    LikelihoodSum_t result_ = 0.0;
+    const LikelihoodSum_t normalizer = get_attachment_log_normalizer();
+    for (auto cell_likelihood : cache.cell_likelihoods) {
+      result_ += cell_likelihood - normalizer;
+    }
+    return (Real_t)result_;
+  }
 
-    for (size_t c = 0; c < cells.get_cells_count(); c++) {
-      state.likelihood_result[c].clear();
-      state.max_attachment.set_attachment(c, get_root_label());
-      state.cell_to_max_attachment_likelihood[c] = state.root_likelihoods[c];
+  /**
+   * Log-likelihood of the last scored tree with path likelihoods summed in
+   * double precision from the stored matrices, used as a reference for the
+   * float mode.
+   */
+  LikelihoodSum_t calculate_reference_likelihood() {
+    auto nodes = tree.get_descendants(tree.get_root());
+    auto &records = cache.ordered_records;
+    std::vector<size_t> parent_positions(nodes.size(), 0);
+    for (size_t i = 1; i < nodes.size(); i++) {
+      parent_positions[i] =
+          cache.get_record(tree.get_node_id(records[i]->parent)).position;
+    }
+    auto &delta = likelihood_matrices.breakpoint_delta;
+    const LikelihoodSum_t normalizer = get_attachment_log_normalizer();
+    std::vector<LikelihoodSum_t> path_likelihoods(nodes.size());
+    LikelihoodSum_t result = 0.0;
+    for (size_t cell = 0; cell < cells.get_cells_count(); cell++) {
+      LogWeightAccumulator<LikelihoodSum_t> cell_likelihood;
+      path_likelihoods[0] = likelihood_matrices.root_likelihoods[cell];
+      for (size_t i = 1; i < nodes.size(); i++) {
+        path_likelihoods[i] = path_likelihoods[parent_positions[i]];
+        for (auto br : tree.get_new_breakpoints(nodes[i])) {
+          path_likelihoods[i] += delta[br][cell];
+        }
+        cell_likelihood.add(path_likelihoods[i] +
+                            records[i]->attachment_log_prior);
+      }
+      result += cell_likelihood.get_result() - normalizer;
     }
+    return result;
+  }
 
-    if (USE_EVENT_LENGTHS_IN_ATTACHMENT) {
-      recalculate_event_lengths();
+  /**
+   * Logs the difference between the float likelihood and its double
+   * precision reference.
+   */
+  void log_float_drift() {
+    if (tree.get_size() < 2) {
+      return;
     }
+    const LikelihoodSum_t reference = calculate_reference_likelihood();
+    log("Float likelihood drift: ", state.likelihood, " vs double ",
+        reference, ", relative difference ",
+        std::abs(state.likelihood - reference) /
+            std::max((LikelihoodSum_t)1.0, std::abs(reference)));
+  }
+
+public:
+  LikelihoodCalculator<Real_t>(
+      EventTree &tree, const LikelihoodCalculatorState<Real_t> &persisted_state,
+      LikelihoodCalculatorState<Real_t> &state,
+      NodeLikelihoodCache<Real_t> &cache, CONETInputData<Real_t> &cells,
+      const LikelihoodMatrices<Real_t> &matrices, ThreadPool &thread_pool)
+      : tree{tree}, persisted_state{persisted_state}, state{state},
+        cache{cache}, cells{cells}, likelihood_matrices{matrices},
+        thread_pool{thread_pool} {}
 
-    for (auto &node : tree.get_children(tree.get_root())) {
-      tree_depth_first_likelihood_calculation(node, state.root_likelihoods);
+  Real_t calculate_likelihood() {
+    const bool full_recalculation =
+        cache.start_calculation(tree.get_node_id_bound());
+    update_records(tree.get_root(), !full_recalculation);
+    if (!full_recalculation) {
+      find_stale_records();
+    }
+
+    const size_t cells_count = cells.get_cells_count();
+    const size_t tasks =
+        std::max((size_t)1, std::min(thread_pool.get_size(),
+                                     cells_count / MIN_CELLS_PER_TASK));
+    cache.changed_attachments.resize(tasks);
+    for (auto &changed : cache.changed_attachments) {
+      changed.clear();
     }
+    thread_pool.run(tasks, [&](size_t task) {
+      calculate_cell_range(cells_count * task / tasks,
+                           cells_count * (task + 1) / tasks, full_recalculation,
+                           cache.changed_attachments[task]);
+    });
+    apply_attachment_changes();
+
     state.likelihood = sum_cell_likelihoods();
+    if constexpr (!std::is_same_v<Real_t, LikelihoodSum_t>) {
+      if (VERBOSE && cache.is_last_calculation_periodic()) {
+        log_float_drift();
+      }
+    }
     return state.likelihood;
   }
 };
 
-#endif
\ No newline at end of file
+#endif
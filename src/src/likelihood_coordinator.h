@@ -13,6 +13,7 @@
 #include "tree/tree_counts_scoring.h"
 #include "utils/log_sum_accumulator.h"
 #include "utils/random.h"
+#include "utils/thread_pool.h"
 #include "utils/utils.h"
 
 template <class Real_t> class LikelihoodCoordinator {
@@ -20,6 +21,8 @@ template <class Real_t> class LikelihoodCoordinator {
 
   LikelihoodCalculatorState<Real_t> calculator_state;
   LikelihoodCalculatorState<Real_t> tmp_calculator_state;
+  NodeLikelihoodCache<Real_t> node_likelihood_cache;
+  ThreadPool thread_pool;
 
   LikelihoodMatrices<Real_t> likelihood_matrices;
   LikelihoodMatrices<Real_t> tmp_likelihood_matrices;
@@ -30,6 +33,8 @@ template <class Real_t> class LikelihoodCoordinator {
   Random<Real_t> random;
   CountsDispersionPenalty<Real_t> counts_scoring;
   size_t step{0};
+  // Number of node records calculated by all likelihood calculations
+  size_t calculated_records{0};
   Utils::MaxValueAccumulator<LikelihoodData<Real_t>, Real_t> map_parameters;
 
   void swap_likelihood_matrices() {
@@ -39,15 +44,17 @@ template <class Real_t> class LikelihoodCoordinator {
 
   void fill_likelihood_matrices() {
     likelihood.fill_breakpoint_log_likelihood_matrix(
-        likelihood_matrices.breakpoint_likelihoods,
-        cells.get_corrected_counts());
+        likelihood_matrices.breakpoint_delta, cells.get_corrected_counts());
     likelihood.fill_no_breakpoint_log_likelihood_matrix(
         likelihood_matrices.no_breakpoint_likelihoods,
         cells.get_corrected_counts());
+    likelihood_matrices.calculate_breakpoint_delta();
+    likelihood_matrices.calculate_root_likelihoods();
   }
 
   void update_likelihood_data_after_parameters_change() {
     fill_likelihood_matrices();
+    node_likelihood_cache.request_full_recalculation();
     calculate_likelihood();
   }
 
@@ -71,10 +78,15 @@ template <class Real_t> class LikelihoodCoordinator {
   }
 
 public:
+  /**
+   * Tree likelihood is calculated with @threads threads.
+   */
   LikelihoodCoordinator(LikelihoodData<Real_t> lk, EventTree &tree,
-                        CONETInputData<Real_t> &cells, unsigned int seed)
+                        CONETInputData<Real_t> &cells, unsigned int seed,
+                        size_t threads = THREADS_LIKELIHOOD)
       : calculator_state{cells.get_cells_count()},
         tmp_calculator_state{cells.get_cells_count()},
+        node_likelihood_cache{cells.get_cells_count()}, thread_pool{threads},
         likelihood_matrices{cells.get_loci_count(), cells.get_cells_count()},
         tmp_likelihood_matrices{cells.get_loci_count(),
                                 cells.get_cells_count()},
@@ -91,6 +103,16 @@ public:
   void persist_likelihood_calculation_result() {
     LikelihoodCalculatorState<Real_t>::swap(calculator_state,
                                             tmp_calculator_state);
+    node_likelihood_cache.commit();
+  }
+
+  /**
+   * Calculates likelihood of the tree from scratch and persists the result.
+   */
+  void recalculate_likelihood() {
+    node_likelihood_cache.request_full_recalculation();
+    calculate_likelihood();
+    persist_likelihood_calculation_result();
   }
 
   Attachment &calculate_max_attachment() {
@@ -98,13 +120,67 @@ public:
   }
 
   Real_t calculate_likelihood() {
-    LikelihoodCalculator<Real_t> calc{tree, tmp_calculator_state, cells,
-                                      likelihood_matrices};
-    return calc.calculate_likelihood();
+    LikelihoodCalculator<Real_t> calc{tree,
+                                      calculator_state,
+                                      tmp_calculator_state,
+                                      node_likelihood_cache,
+                                      cells,
+                                      likelihood_matrices,
+                                      thread_pool};
+    const Real_t result = calc.calculate_likelihood();
+    calculated_records += node_likelihood_cache.pending_order.size();
+    return result;
+  }
+
+  size_t get_calculated_records_count() const { return calculated_records; }
+
+  /**
+   * Returns for each locus and cell whether breakpoint at the locus is more
+   * likely than no breakpoint.
+   */
+  std::vector<std::vector<bool>> get_breakpoint_support() const {
+    auto &delta = likelihood_matrices.breakpoint_delta;
+    std::vector<std::vector<bool>> support(delta.rows());
+    for (size_t locus = 0; locus < delta.rows(); locus++) {
+      for (size_t cell = 0; cell < delta.columns(); cell++) {
+        support[locus].push_back(delta[locus][cell] > 0.0);
+      }
+    }
+    return support;
+  }
+
+  /**
+   * Returns evidence for a breakpoint at each locus - mean over cells of
+   * softplus of the difference between breakpoint and no-breakpoint
+   * log-likelihoods.
+   */
+  std::vector<Real_t> get_breakpoint_evidence() const {
+    auto &delta = likelihood_matrices.breakpoint_delta;
+    std::vector<Real_t> evidence;
+    for (size_t locus = 0; locus < delta.rows(); locus++) {
+      Real_t sum = 0.0;
+      for (size_t cell = 0; cell < delta.columns(); cell++) {
+        const Real_t d = delta[locus][cell];
+        sum += d > 0.0 ? d + std::log1p(std::exp(-d)) : std::log1p(std::exp(d));
+      }
+      evidence.push_back(sum / delta.columns());
+    }
+    return evidence;
   }
 
   LikelihoodData<Real_t> get_map_parameters() { return map_parameters.get(); }
 
+  LikelihoodData<Real_t> get_likelihood_data() const { return likelihood; }
+
+  /**
+   * Matrices of the current likelihood parameters. They are swapped with
+   * matrices of proposed parameters by resample_likelihood_parameters, so
+   * references are stable only while parameters are not resampled.
+   */
+  const LikelihoodMatrices<Real_t> &get_likelihood_matrices() const {
+    return likelihood_matrices;
+  }
+
   void resample_likelihood_parameters(Real_t log_tree_prior,
                                       Real_t tree_count_score) {
     auto likelihood_before_move = get_likelihood() +
@@ -0,0 +1,122 @@
+#ifndef MOVE_TYPE_SCHEDULER_H
+#define MOVE_TYPE_SCHEDULER_H
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include "../utils/alias_table.h"
+#include "../utils/logger/logger.h"
+#include "../utils/random.h"
+#include "move_type.h"
+
+/**
+ * Samples MH move types with adaptable weights.
+ *
+ * Weights may be adapted during a limited number of steps towards the
+ * absolute change of log target by accepted moves per unit of likelihood
+ * evaluation cost of each move type.
+ * Adaptation steps diminish and weights stay bounded away from zero, then the
+ * weights are frozen.
+ */
+template <class Real_t> class MoveTypeScheduler {
+  static constexpr size_t ADAPTATION_INTERVAL = 500;
+  // Fraction of the mean weight below which no weight is adapted
+  static constexpr Real_t MIN_RELATIVE_WEIGHT = 0.25;
+
+  struct MoveStatistics {
+    Real_t improvement{0.0};
+    Real_t cost{0.0};
+  };
+
+  std::vector<MoveType> types;
+  // Weight of each move type, indexed by MoveType
+  std::vector<Real_t> weights;
+  std::vector<MoveStatistics> statistics;
+  AliasTable<Real_t> alias_table;
+
+  size_t adaptation_steps{0};
+  size_t steps{0};
+  size_t adaptations{0};
+
+  void build_alias_table() {
+    std::vector<Real_t> type_weights;
+    for (auto type : types) {
+      type_weights.push_back(weights[type]);
+    }
+    alias_table = AliasTable<Real_t>(type_weights);
+  }
+
+  void adapt() {
+    Real_t weights_sum = 0.0;
+    Real_t efficiency_sum = 0.0;
+    std::vector<Real_t> efficiency;
+    for (auto type : types) {
+      weights_sum += weights[type];
+      efficiency.push_back((statistics[type].improvement + 1.0) /
+                           (statistics[type].cost + 1.0));
+      efficiency_sum += efficiency.back();
+    }
+    const Real_t min_weight = MIN_RELATIVE_WEIGHT * weights_sum / types.size();
+    const Real_t step_size = 1.0 / std::sqrt(adaptations + 2.0);
+    for (size_t i = 0; i < types.size(); i++) {
+      const Real_t target = std::max(
+          min_weight, weights_sum * efficiency[i] / efficiency_sum);
+      weights[types[i]] += step_size * (target - weights[types[i]]);
+    }
+    adaptations++;
+    build_alias_table();
+  }
+
+public:
+  MoveTypeScheduler(const std::map<MoveType, Real_t> &move_weights)
+      : weights(SWAP_ONE_BREAKPOINT + 1, 0.0),
+        statistics(SWAP_ONE_BREAKPOINT + 1) {
+    for (auto &type_weight : move_weights) {
+      types.push_back(type_weight.first);
+      weights[type_weight.first] = type_weight.second;
+    }
+    build_alias_table();
+  }
+
+  MoveType sample(Random<Real_t> &random) const {
+    return types[alias_table.sample(random)];
+  }
+
+  Real_t get_weight(MoveType type) const { return weights[type]; }
+
+  /**
+   * Weights will be adapted during the next @steps recorded steps
+   */
+  void enable_adaptation(size_t steps) {
+    adaptation_steps = steps;
+    this->steps = 0;
+  }
+
+  /**
+   * Records result of a step with move of type @type.
+   *
+   * @param log_target_change - change of the log target, zero if the move has
+   * been rejected
+   * @param cost - number of node likelihood records calculated by the step
+   */
+  void record(MoveType type, Real_t log_target_change, size_t cost) {
+    if (steps >= adaptation_steps) {
+      return;
+    }
+    statistics[type].improvement += std::abs(log_target_change);
+    // Every step has some cost apart from likelihood calculation
+    statistics[type].cost += cost + 1.0;
+    steps++;
+    if (steps % ADAPTATION_INTERVAL == 0) {
+      adapt();
+    }
+    if (steps == adaptation_steps) {
+      for (auto type : types) {
+        log_debug("Frozen weight of move ", move_type_to_string(type), ": ",
+                  weights[type]);
+      }
+    }
+  }
+};
+
+#endif // !MOVE_TYPE_SCHEDULER_H
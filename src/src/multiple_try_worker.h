@@ -0,0 +1,212 @@
+#ifndef MULTIPLE_TRY_WORKER_H
+#define MULTIPLE_TRY_WORKER_H
+
+#include "input_data/input_data.h"
+#include "likelihood_calculator.h"
+#include "moves/move_type.h"
+#include "tree/event_tree.h"
+#include "tree/tree_counts_scoring.h"
+#include "tree_mh_steps_executor.h"
+#include "utils/random.h"
+#include "utils/thread_pool.h"
+
+/**
+ * Copy of sampler state used by multiple-try Metropolis and speculative
+ * steps.
+ *
+ * Worker owns a copy of the replica's tree together with its own likelihood
+ * calculation state, so that many workers may score proposals in parallel.
+ * Likelihood matrices are shared with the replica, whose parameters must not
+ * change while workers exist. Proposals are always rolled back, accepted
+ * moves are replayed on the worker tree to keep it equal to the replica's
+ * tree.
+ */
+template <class Real_t> class MultipleTryWorker {
+  using MoveData = typename MHStepsExecutor<Real_t>::MoveData;
+  using MoveReplay = typename MHStepsExecutor<Real_t>::MoveReplay;
+  using MoveLabels = typename MHStepsExecutor<Real_t>::MoveLabels;
+
+  EventTree tree;
+  Random<Real_t> random;
+  CONETInputData<Real_t> &cells;
+  const LikelihoodMatrices<Real_t> &likelihood_matrices;
+  LikelihoodCalculatorState<Real_t> calculator_state;
+  LikelihoodCalculatorState<Real_t> tmp_calculator_state;
+  NodeLikelihoodCache<Real_t> node_likelihood_cache;
+  ThreadPool thread_pool{1};
+  CountsDispersionPenalty<Real_t> dispersion_penalty_calculator;
+  MHStepsExecutor<Real_t> mh_step_executor;
+
+  // Move replayed on the tree which has not been committed yet
+  bool replayed{false};
+  MoveReplay replayed_move;
+  MoveData replayed_move_data;
+  // Proposals executed after the replay may recreate nodes of
+  // @replayed_move_data, so their handles are refreshed before rollback
+  MoveLabels replayed_move_labels;
+  // Informed reattachment needs attachment of cells to the replayed tree
+  bool informed_reattachment{false};
+  Attachment replayed_attachment;
+
+public:
+  struct Proposal {
+    // False if sampled move was not possible, proposal is equal to the
+    // current state then
+    bool is_move{false};
+    MoveReplay move;
+    // Tempered likelihood plus tree prior and counts dispersion penalty
+    Real_t log_target{0.0};
+    Real_t counts_dispersion_penalty{0.0};
+    // Proposal kernels part of the MH log acceptance ratio
+    Real_t log_proposal_ratio{0.0};
+  };
+
+private:
+  Real_t calculate_likelihood() {
+    LikelihoodCalculator<Real_t> calc{tree,
+                                      calculator_state,
+                                      tmp_calculator_state,
+                                      node_likelihood_cache,
+                                      cells,
+                                      likelihood_matrices,
+                                      thread_pool};
+    return calc.calculate_likelihood();
+  }
+
+  void persist_likelihood_calculation_result() {
+    LikelihoodCalculatorState<Real_t>::swap(calculator_state,
+                                            tmp_calculator_state);
+    node_likelihood_cache.commit();
+  }
+
+  void restore_attachment() {
+    if (informed_reattachment) {
+      mh_step_executor.set_attachment(&calculator_state.max_attachment);
+    }
+  }
+
+  void score_tree(Proposal &proposal, Real_t temperature) {
+    proposal.log_target = temperature * calculate_likelihood() +
+                          mh_step_executor.get_log_tree_prior();
+    proposal.counts_dispersion_penalty =
+        dispersion_penalty_calculator.calculate_log_score(
+            tree, tmp_calculator_state.max_attachment);
+    proposal.log_target += proposal.counts_dispersion_penalty;
+  }
+
+public:
+  MultipleTryWorker(const EventTree &source_tree,
+                    const LikelihoodMatrices<Real_t> &matrices,
+                    CONETInputData<Real_t> &cells, unsigned int seed)
+      : tree{source_tree}, random{seed}, cells{cells},
+        likelihood_matrices{matrices},
+        calculator_state{cells.get_cells_count()},
+        tmp_calculator_state{cells.get_cells_count()},
+        node_likelihood_cache{cells.get_cells_count()},
+        dispersion_penalty_calculator{cells}, mh_step_executor{tree, cells,
+                                                               random},
+        replayed_attachment{get_root_label(), cells.get_cells_count()} {
+    calculate_likelihood();
+    persist_likelihood_calculation_result();
+  }
+
+  Random<Real_t> &get_random() { return random; }
+
+  /**
+   * See MHStepsExecutor::enable_informed_label_proposals.
+   */
+  void enable_informed_label_proposals(std::vector<Real_t> locus_weights) {
+    mh_step_executor.enable_informed_label_proposals(std::move(locus_weights));
+  }
+
+  /**
+   * See MHStepsExecutor::enable_informed_reattachment. Replays of moves
+   * calculate attachment of cells to the replayed tree afterwards, which
+   * costs one likelihood calculation per replay.
+   */
+  void enable_informed_reattachment(std::vector<std::vector<bool>> support) {
+    mh_step_executor.enable_informed_reattachment(std::move(support));
+    mh_step_executor.set_attachment(&calculator_state.max_attachment);
+    informed_reattachment = true;
+  }
+
+  /**
+   * Executes move of type @type on the worker tree, scores the result and
+   * rolls the move back.
+   *
+   * @param log_type_ratio - move type term of the log acceptance ratio
+   */
+  Proposal propose(MoveType type, Real_t log_type_ratio, Real_t temperature) {
+    Proposal proposal;
+    if (!mh_step_executor.move_is_possible(type)) {
+      return proposal;
+    }
+    auto move_data = mh_step_executor.execute_move(type);
+    proposal.is_move = true;
+    proposal.move = mh_step_executor.describe_move(type, move_data);
+    score_tree(proposal, temperature);
+    if (move_data.informed) {
+      mh_step_executor.complete_reverse_move_log_kernel(
+          move_data, tmp_calculator_state.max_attachment);
+    }
+    proposal.log_proposal_ratio = move_data.reverse_move_log_kernel -
+                                  move_data.move_log_kernel + log_type_ratio;
+    mh_step_executor.rollback_move(type, move_data);
+    return proposal;
+  }
+
+  /**
+   * Scores tree obtained by applying @move to the worker tree, which is left
+   * unchanged. Proposal kernels are not calculated.
+   */
+  Proposal score(const MoveReplay &move, Real_t temperature) {
+    Proposal proposal;
+    proposal.is_move = true;
+    proposal.move = move;
+    replay(move);
+    score_tree(proposal, temperature);
+    rollback_replay();
+    return proposal;
+  }
+
+  /**
+   * Applies @move to the worker tree without committing it.
+   */
+  void replay(const MoveReplay &move) {
+    replayed_move_data = mh_step_executor.replay_move(move);
+    replayed_move = move;
+    replayed = true;
+    replayed_move_labels = mh_step_executor.get_node_labels(replayed_move_data);
+    if (informed_reattachment) {
+      calculate_likelihood();
+      replayed_attachment = tmp_calculator_state.max_attachment;
+      mh_step_executor.set_attachment(&replayed_attachment);
+    }
+  }
+
+  void rollback_replay() {
+    if (replayed) {
+      mh_step_executor.refresh_node_handles(replayed_move_data,
+                                            replayed_move_labels);
+      mh_step_executor.rollback_move(replayed_move.type, replayed_move_data);
+      replayed = false;
+      restore_attachment();
+    }
+  }
+
+  /**
+   * Makes @move a part of the current worker state. The move is replayed
+   * first, unless it has already been replayed.
+   */
+  void commit(const MoveReplay &move) {
+    if (!replayed) {
+      replay(move);
+    }
+    calculate_likelihood();
+    persist_likelihood_calculation_result();
+    replayed = false;
+    restore_attachment();
+  }
+};
+
+#endif // !MULTIPLE_TRY_WORKER_H
@@ -1,8 +1,10 @@
 #ifndef PARALLEL_TEMPERING_COORDINATOR_H
 #define PARALLEL_TEMPERING_COORDINATOR_H
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <map>
 #include <mutex>
 #include <thread>
 #include <utility>
@@ -34,8 +36,10 @@ template <class Real_t> class ParallelTemperingCoordinator {
       tree_sampling_coordinators;
   std::vector<std::unique_ptr<LikelihoodCoordinator<Real_t>>>
       likelihood_calculators;
+  // Cells subsample scored by replicas with approximate likelihood
+  std::unique_ptr<CONETInputData<Real_t>> approximate_cells;
 
-  const std::map<MoveType, double> move_probabilities = {
+  const std::map<MoveType, Real_t> move_probabilities = {
       {DELETE_LEAF, 100.0},       {ADD_LEAF, 30.0},     {PRUNE_REATTACH, 30.0},
       {SWAP_LABELS, 30.0},        {CHANGE_LABEL, 30.0}, {SWAP_SUBTREES, 30.0},
       {SWAP_ONE_BREAKPOINT, 30.0}};
@@ -45,24 +49,47 @@ template <class Real_t> class ParallelTemperingCoordinator {
 
   EventTree sample_starting_tree_for_chain() {
     log("Sampling initial tree for chain with size ", INIT_TREE_SIZE);
-    VertexLabelSampler<Real_t> vertexSet{provider.get_loci_count() - 1,
-                                         provider.get_chromosome_end_markers()};
+    VertexLabelSampler<Real_t> vertexSet{provider};
     return sample_tree<Real_t>(INIT_TREE_SIZE, vertexSet, random);
   }
 
   void prepare_sampling_services(LikelihoodData<Real_t> likelihood) {
     log("Starting preparation of sampling services with ", NUM_REPLICAS, " replicas...");
+    // Replicas are simulated in parallel, so they share likelihood threads
+    const size_t threads_per_replica =
+        std::max((size_t)1, THREADS_LIKELIHOOD / NUM_REPLICAS);
     for (size_t i = 0; i < NUM_REPLICAS; i++) {
       trees.push_back(sample_starting_tree_for_chain());
     }
+    prepare_approximate_cells();
     for (size_t i = 0; i < NUM_REPLICAS; i++) {
       likelihood_calculators.push_back(
           std::move(std::make_unique<LikelihoodCoordinator<Real_t>>(
-              likelihood, trees[i], provider, random.next_int())));
+              likelihood, trees[i], provider, random.next_int(),
+              threads_per_replica)));
       tree_sampling_coordinators.push_back(
           std::move(std::make_unique<TreeSamplerCoordinator<Real_t>>(
               trees[i], *likelihood_calculators[i], random.next_int(), provider,
               move_probabilities)));
+      if (INFORMED_LABEL_PROPOSALS) {
+        tree_sampling_coordinators.back()->enable_informed_label_proposals();
+      }
+      if (INFORMED_REATTACHMENT) {
+        tree_sampling_coordinators.back()->enable_informed_reattachment();
+      }
+      if (MTM_TRIES > 1) {
+        tree_sampling_coordinators.back()->enable_multiple_try(MTM_TRIES);
+      } else if (SPECULATIVE_STEPS > 1) {
+        tree_sampling_coordinators.back()->enable_speculative_steps(
+            SPECULATIVE_STEPS);
+      } else {
+        tree_sampling_coordinators.back()->enable_delayed_acceptance(
+            DELAYED_ACCEPTANCE_CELLS, threads_per_replica);
+        if (approximate_cells) {
+          tree_sampling_coordinators.back()->enable_approximate_likelihood(
+              *approximate_cells, threads_per_replica);
+        }
+      }
     }
     log("PID 0 replica will start with temperature ", 1.0);
     temperatures.push_back(1.0);
@@ -72,7 +99,57 @@ template <class Real_t> class ParallelTemperingCoordinator {
     }
     for (size_t i = 0; i < NUM_REPLICAS; i++) {
       tree_sampling_coordinators[i]->set_temperature(temperatures[i]);
+      tree_sampling_coordinators[i]->set_approximate(is_approximate_replica(i));
+      tree_sampling_coordinators[i]->enable_move_type_adaptation(
+          MOVE_TYPE_ADAPTATION_STEPS);
+    }
+  }
+
+  /**
+   * If approximate likelihood is enabled, all replicas except for the first
+   * @EXACT_REPLICAS ones, which have the highest temperatures, target it.
+   */
+  bool is_approximate_replica(size_t replica) const {
+    return approximate_cells && replica >= EXACT_REPLICAS;
+  }
+
+  void prepare_approximate_cells() {
+    const size_t cells_count = provider.get_cells_count();
+    if (APPROXIMATE_REPLICAS_CELLS == 0 ||
+        APPROXIMATE_REPLICAS_CELLS >= cells_count || MTM_TRIES > 1 ||
+        SPECULATIVE_STEPS > 1 || NUM_REPLICAS <= EXACT_REPLICAS) {
+      return;
+    }
+    approximate_cells = std::make_unique<CONETInputData<Real_t>>(
+        provider.get_cells_subset(
+            random.subset(cells_count, APPROXIMATE_REPLICAS_CELLS)));
+    log("Replicas with index at least ", EXACT_REPLICAS,
+        " will score trees on ", APPROXIMATE_REPLICAS_CELLS, " cells");
+  }
+
+  /**
+   * Log acceptance ratio of the swap of trees of replicas @left and @right.
+   * Counts dispersion penalty and tree prior cancel out unless the replicas
+   * target likelihoods of different fidelity.
+   */
+  Real_t get_swap_log_acceptance(size_t left, size_t right) {
+    auto &left_sampler = *tree_sampling_coordinators[left];
+    auto &right_sampler = *tree_sampling_coordinators[right];
+    if (is_approximate_replica(left) == is_approximate_replica(right)) {
+      return (temperatures[left] - temperatures[right]) *
+             (right_sampler.get_likelihood_without_priors_and_penalty() -
+              left_sampler.get_likelihood_without_priors_and_penalty());
     }
+    const bool left_approximate = is_approximate_replica(left);
+    const bool right_approximate = is_approximate_replica(right);
+    return right_sampler.get_tempered_likelihood_with_penalty(
+               temperatures[left], left_approximate) +
+           left_sampler.get_tempered_likelihood_with_penalty(
+               temperatures[right], right_approximate) -
+           left_sampler.get_tempered_likelihood_with_penalty(
+               temperatures[left], left_approximate) -
+           right_sampler.get_tempered_likelihood_with_penalty(
+               temperatures[right], right_approximate);
   }
 
   LikelihoodData<Real_t>
@@ -87,9 +164,7 @@ template <class Real_t> class ParallelTemperingCoordinator {
 
     for (size_t i = 0; i < iterations; i++) {
       if (i % PARAMETER_RESAMPLING_FREQUENCY == 0) {
-        calc.resample_likelihood_parameters(
-            coordinator.get_log_tree_prior(),
-            coordinator.get_current_count_dispersion_penalty());
+        coordinator.resample_likelihood_parameters();
       }
       coordinator.execute_metropolis_hastings_step();
     }
@@ -109,9 +184,9 @@ template <class Real_t> class ParallelTemperingCoordinator {
       std::vector<std::thread> threads;
       for (size_t th = 0; th < NUM_REPLICAS; th++) {
         threads.emplace_back([this, th] {
-          for (size_t i = 0; i < (size_t)NUMBER_OF_MOVES_BETWEEN_SWAPS; i++)
-            this->tree_sampling_coordinators[th]
-                ->execute_metropolis_hastings_step();
+          this->tree_sampling_coordinators[th]
+              ->execute_metropolis_hastings_steps(
+                  NUMBER_OF_MOVES_BETWEEN_SWAPS);
         });
       }
       for (auto &th : threads) {
@@ -137,7 +212,8 @@ template <class Real_t> class ParallelTemperingCoordinator {
     }
     std::vector<Real_t> states;
     for (size_t i = 0; i < likelihood_calculators.size(); i++) {
-      states.push_back(likelihood_calculators[i]->get_likelihood());
+      states.push_back(tree_sampling_coordinators[i]
+                           ->get_likelihood_without_priors_and_penalty());
     }
     adaptive_pt.update(states);
     this->temperatures = adaptive_pt.get_temperatures();
@@ -146,25 +222,24 @@ template <class Real_t> class ParallelTemperingCoordinator {
       tree_sampling_coordinators[i]->set_temperature(temperatures[i]);
     }
     int pid = random.next_int(NUM_REPLICAS - 1);
-    auto likelihood_left = tree_sampling_coordinators[pid]
-                               ->get_likelihood_without_priors_and_penalty();
-    auto likelihood_right = tree_sampling_coordinators[pid + 1]
-                                ->get_likelihood_without_priors_and_penalty();
-    Real_t swap_acceptance_ratio = (temperatures[pid] - temperatures[pid + 1]) *
-                                   (likelihood_right - likelihood_left);
+    Real_t swap_acceptance_ratio = get_swap_log_acceptance(pid, pid + 1);
     if (random.log_uniform() <= swap_acceptance_ratio) {
       tree_sampling_coordinators[pid]->set_temperature(temperatures[pid + 1]);
       tree_sampling_coordinators[pid + 1]->set_temperature(temperatures[pid]);
       std::swap(tree_sampling_coordinators[pid],
                 tree_sampling_coordinators[pid + 1]);
       std::swap(likelihood_calculators[pid], likelihood_calculators[pid + 1]);
+      tree_sampling_coordinators[pid]->set_approximate(
+          is_approximate_replica(pid));
+      tree_sampling_coordinators[pid + 1]->set_approximate(
+          is_approximate_replica(pid + 1));
     }
   }
 
   LikelihoodData<Real_t> prepare_initial_likelihood_parameters() {
     log("Initializing EM estimator...");
-    Gauss::EMEstimator<Real_t> EM(
-        Utils::flatten<Real_t>(provider.get_corrected_counts()), random);
+    Gauss::EMEstimator<Real_t> EM(provider.get_corrected_counts().flatten(),
+                                  random);
     log("Starting EM estimation of mixture with ", MIXTURE_SIZE, " components");
     auto result = EM.estimate(MIXTURE_SIZE)
         .remove_components_with_small_weight(MIN_COMPONENT_WEIGHT);
@@ -9,6 +9,16 @@ double EVENTS_LENGTH_PENALTY = 1.0;
 size_t PARAMETER_RESAMPLING_FREQUENCY = 10;
 size_t NUMBER_OF_MOVES_BETWEEN_SWAPS = 10;
 size_t THREADS_LIKELIHOOD = 10;
+size_t MTM_TRIES = 1;
+size_t SPECULATIVE_STEPS = 1;
+size_t DELAYED_ACCEPTANCE_CELLS = 0;
+size_t APPROXIMATE_REPLICAS_CELLS = 0;
+size_t EXACT_REPLICAS = 1;
+size_t MOVE_TYPE_ADAPTATION_STEPS = 0;
+bool INFORMED_LABEL_PROPOSALS = false;
+bool INFORMED_REATTACHMENT = false;
+size_t MAX_EVENT_LOCI = 0;
+double MAX_EVENT_LENGTH = 0.0;
 size_t MIXTURE_SIZE = 8;
 long SEED = 12312414;
 bool VERBOSE = false;
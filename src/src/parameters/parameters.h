@@ -5,6 +5,16 @@
 
 extern size_t NUM_REPLICAS;
 extern size_t THREADS_LIKELIHOOD;
+extern size_t MTM_TRIES;
+extern size_t SPECULATIVE_STEPS;
+extern size_t DELAYED_ACCEPTANCE_CELLS;
+extern size_t APPROXIMATE_REPLICAS_CELLS;
+extern size_t EXACT_REPLICAS;
+extern size_t MOVE_TYPE_ADAPTATION_STEPS;
+extern bool INFORMED_LABEL_PROPOSALS;
+extern bool INFORMED_REATTACHMENT;
+extern size_t MAX_EVENT_LOCI;
+extern double MAX_EVENT_LENGTH;
 extern bool USE_EVENT_LENGTHS_IN_ATTACHMENT;
 extern double DATA_SIZE_PRIOR_CONSTANT;
 extern double COUNTS_SCORE_CONSTANT_0;
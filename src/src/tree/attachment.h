@@ -2,7 +2,6 @@
 #define ATTACHMENT_H
 #include <algorithm>
 #include <iostream>
-#include <map>
 #include <vector>
 
 #include "../types.h"
@@ -10,35 +9,88 @@
 /**
  * @brief Attachment of cells to Event Tree nodes
  *
+ * Attachment keeps an index of cells attached to each node id, which is
+ * updated by set_attachment in O(1) time per changed cell. Changes are not
+ * thread safe, attachments written by many threads should collect changed
+ * cells and apply them afterwards.
  */
 class Attachment {
   std::vector<TreeLabel> cell_to_tree_label;
+  // Ids of nodes labeled with @cell_to_tree_label, see EventTree::Node::id
+  std::vector<size_t> cell_to_node_id;
+  // Cells attached to each node id, in no particular order
+  std::vector<std::vector<size_t>> node_id_to_cells;
+  // Position of each cell in its list of @node_id_to_cells
+  std::vector<size_t> cell_positions;
 
-public:
-  Attachment(TreeLabel default_label, size_t cells) {
-    for (size_t i = 0; i < cells; i++) {
-      cell_to_tree_label.push_back(default_label);
+  void add_to_index(size_t cell, size_t node_id) {
+    if (node_id >= node_id_to_cells.size()) {
+      node_id_to_cells.resize(node_id + 1);
     }
+    cell_positions[cell] = node_id_to_cells[node_id].size();
+    node_id_to_cells[node_id].push_back(cell);
   }
 
-  bool has_attached_cells(TreeLabel label) const {
-    return std::find(cell_to_tree_label.begin(), cell_to_tree_label.end(),
-                     label) != cell_to_tree_label.end();
+  void remove_from_index(size_t cell, size_t node_id) {
+    auto &cells = node_id_to_cells[node_id];
+    const size_t last = cells.back();
+    cells[cell_positions[cell]] = last;
+    cell_positions[last] = cell_positions[cell];
+    cells.pop_back();
   }
 
-  void set_attachment(size_t cell, TreeLabel node) {
+public:
+  Attachment(TreeLabel default_label, size_t cells, size_t default_node_id = 0)
+      : cell_to_tree_label(cells, default_label),
+        cell_to_node_id(cells, default_node_id), cell_positions(cells) {
+    for (size_t cell = 0; cell < cells; cell++) {
+      add_to_index(cell, default_node_id);
+    }
+  }
+
+  void set_attachment(size_t cell, TreeLabel node, size_t node_id) {
     cell_to_tree_label[cell] = node;
+    if (cell_to_node_id[cell] != node_id) {
+      remove_from_index(cell, cell_to_node_id[cell]);
+      add_to_index(cell, node_id);
+      cell_to_node_id[cell] = node_id;
+    }
+  }
+
+  TreeLabel get_label(size_t cell) const { return cell_to_tree_label[cell]; }
+
+  size_t get_node_id(size_t cell) const { return cell_to_node_id[cell]; }
+
+  /**
+   * Returns cells attached to the node with id @node_id, in no particular
+   * order.
+   */
+  const std::vector<size_t> &get_attached_cells(size_t node_id) const {
+    static const std::vector<size_t> no_cells;
+    return node_id < node_id_to_cells.size() ? node_id_to_cells[node_id]
+                                             : no_cells;
+  }
+
+  size_t count_attached_cells(size_t node_id) const {
+    return get_attached_cells(node_id).size();
+  }
+
+  bool has_attached_cells(size_t node_id) const {
+    return count_attached_cells(node_id) > 0;
   }
 
-  std::map<TreeLabel, std::set<size_t>> get_node_label_to_cells_map() const {
-    std::map<TreeLabel, std::set<size_t>> node_to_cells;
-    for (size_t cell = 0; cell < cell_to_tree_label.size(); cell++) {
-      if (node_to_cells.find(cell_to_tree_label[cell]) == node_to_cells.end()) {
-        node_to_cells[cell_to_tree_label[cell]] = std::set<size_t>();
-      }
-      node_to_cells[cell_to_tree_label[cell]].insert(cell);
+  /**
+   * Sets @node_to_cells[id] to sorted list of cells attached to the node with
+   * id @id, for each id smaller than @node_id_bound.
+   */
+  void get_node_id_to_cells(std::vector<std::vector<size_t>> &node_to_cells,
+                            size_t node_id_bound) const {
+    node_to_cells.resize(node_id_bound);
+    for (size_t id = 0; id < node_id_bound; id++) {
+      auto &cells = get_attached_cells(id);
+      node_to_cells[id].assign(cells.begin(), cells.end());
+      std::sort(node_to_cells[id].begin(), node_to_cells[id].end());
     }
-    return node_to_cells;
   }
 
   friend std::ostream &operator<<(std::ostream &stream,
@@ -52,6 +104,9 @@ public:
 
   friend void swap(Attachment &a, Attachment &b) {
     std::swap(a.cell_to_tree_label, b.cell_to_tree_label);
+    std::swap(a.cell_to_node_id, b.cell_to_node_id);
+    std::swap(a.node_id_to_cells, b.node_id_to_cells);
+    std::swap(a.cell_positions, b.cell_positions);
   }
 };
 #endif
\ No newline at end of file
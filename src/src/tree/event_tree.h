@@ -1,12 +1,11 @@
 #ifndef EVENT_TREE_H
 #define EVENT_TREE_H
 #include <algorithm>
+#include <array>
 #include <cassert>
-#include <list>
-#include <map>
-#include <set>
+#include <cstdint>
+#include <limits>
 #include <string>
-#include <unordered_set>
 #include <vector>
 
 #include "../types.h"
@@ -17,166 +16,359 @@
  * @brief Class representing CONET
  *
  * Rooted tree with arbitrary degree.
+ *
+ * Nodes are kept in an arena indexed by 32-bit node handles, which are equal
+ * to node ids. Children of each node are stored in a contiguous block of a
+ * pool shared by all nodes, so the tree owns only a few flat arrays and its
+ * copy doesn't allocate memory per node.
+ *
+ * Tree maintains its depth first order together with subtree sizes, so the
+ * subtree of each node is a contiguous range of the order. Ancestor queries,
+ * counting and indexing of descendants and non descendants take O(1) time.
  */
 class EventTree {
 public:
-  class Node {
+  typedef uint32_t NodeHandle;
+  // Handle which doesn't point to any node, e.g. parent of the root
+  static constexpr NodeHandle NULL_NODE = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * Read-only view of contiguous elements owned by the tree. It is valid
+   * until the next modification of the tree.
+   */
+  template <class T> class Range {
+    const T *first;
+    const T *last;
+
   public:
-    Node *parent;
-    std::list<Node *> children;
-    TreeLabel label;
+    Range(const T *first, const T *last) : first{first}, last{last} {}
+    const T *begin() const { return first; }
+    const T *end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    const T &front() const { return *first; }
+    const T &back() const { return *(last - 1); }
+  };
+
+private:
+  struct Node {
+    NodeHandle parent{NULL_NODE};
+    TreeLabel label{0, 0};
+    // Children are stored in @children_pool at positions
+    // [children_offset, children_offset + children_count)
+    uint32_t children_offset{0};
+    uint32_t children_count{0};
+    uint32_t children_capacity{0};
     // Loci which are breakpoints in this node and are not present in any
     // ancestor nodes
-    std::list<Locus> new_breakpoints;
-    Node() : parent{nullptr} {}
-    Node(TreeLabel label, std::list<Locus> nb)
-        : parent{nullptr}, children{}, label{label}, new_breakpoints{nb} {}
-    ~Node() {
-      for (auto node : this->children) {
-        delete node;
-      }
-    }
+    uint32_t new_breakpoints_count{0};
+    std::array<Locus, 2> new_breakpoints{{0, 0}};
+    // Position of the node in @preorder
+    uint32_t preorder_position{0};
+    // Number of nodes in the subtree rooted at the node, the node included
+    uint32_t subtree_size{1};
   };
-  typedef Node *NodeHandle;
 
-private:
+  static constexpr NodeHandle ROOT = 0;
+  // Pool is compacted when more than this many slots are unused and they
+  // make up more than half of the pool
+  static constexpr size_t MIN_COMPACTED_SLOTS = 64;
+
   // Tree is always rooted
   size_t size{1};
-  EventTree::Node *root;
+  // Indexed by node handles, all handles are smaller than its size
+  std::vector<Node> nodes = std::vector<Node>(1);
+  std::vector<NodeHandle> children_pool;
+  // Number of slots of @children_pool which don't belong to any node
+  size_t unused_children_slots{0};
+  // Buffer reused by compaction of @children_pool
+  std::vector<NodeHandle> compacted_children_pool;
+  // Ids of deleted nodes. The most recently released id is reused first, so
+  // deleting a leaf and adding it back restores its id.
+  std::vector<NodeHandle> free_ids;
+  // Nodes in depth first order, children are visited in the order of their
+  // attachment
+  std::vector<NodeHandle> preorder = std::vector<NodeHandle>(1, ROOT);
+  // Buffers reused by update_new_breakpoints. @breakpoint_multiplicity[l] is
+  // the number of nodes on the current path from the root with breakpoint l.
+  std::vector<uint32_t> breakpoint_multiplicity;
+  std::vector<NodeHandle> breakpoints_path;
   using NodeVector = std::vector<NodeHandle>;
 
+  NodeHandle acquire_id() {
+    if (free_ids.empty()) {
+      nodes.emplace_back();
+      return nodes.size() - 1;
+    }
+    auto id = free_ids.back();
+    free_ids.pop_back();
+    return id;
+  }
+
   NodeHandle create_detached_node(TreeLabel label) {
-    return new Node(label, get_event_breakpoints(get_event_from_label(label)));
+    auto node = acquire_id();
+    nodes[node] = Node();
+    nodes[node].label = label;
+    return node;
   }
 
-  void
-  gather_ancestor_breakpoints(Node *node,
-                              std::unordered_set<Locus> &breakpoints) const {
-    if (node != root) {
-      for (Locus l : get_event_breakpoints(get_event_from_label(node->label))) {
-        breakpoints.insert(l);
-      }
-      gather_ancestor_breakpoints(node->parent, breakpoints);
-    }
+  void release_node(NodeHandle node) {
+    unused_children_slots += nodes[node].children_capacity;
+    nodes[node] = Node();
+    free_ids.push_back(node);
+  }
+
+  NodeHandle *children_begin(NodeHandle node) {
+    return children_pool.data() + nodes[node].children_offset;
   }
 
   /**
-   * Update @new_breakpoints list for nodes in subtree rooted at @node
-   *
-   * @param node - subtree rott
-   * @param breakpoints_from_ancestors - all breakpoints from ancestors of @node
+   * Moves children of @node to a new block at the end of the pool, twice as
+   * large as the current one.
    */
-  void update_new_breakpoints(
-      NodeHandle node, std::unordered_set<size_t> &breakpoints_from_ancestors) {
-    if (node != root) {
-      node->new_breakpoints =
-          get_event_breakpoints(get_event_from_label(node->label));
-      node->new_breakpoints.remove_if([&breakpoints_from_ancestors](Locus br) {
-        return breakpoints_from_ancestors.find(br) !=
-               breakpoints_from_ancestors.end();
-      });
+  void grow_children_block(NodeHandle node) {
+    auto &n = nodes[node];
+    const uint32_t capacity = std::max<uint32_t>(2, 2 * n.children_capacity);
+    if (n.children_capacity > 0 &&
+        n.children_offset + n.children_capacity == children_pool.size()) {
+      children_pool.resize(n.children_offset + capacity);
+    } else {
+      const size_t offset = children_pool.size();
+      children_pool.resize(offset + capacity);
+      std::copy(children_pool.begin() + n.children_offset,
+                children_pool.begin() + n.children_offset + n.children_count,
+                children_pool.begin() + offset);
+      unused_children_slots += n.children_capacity;
+      n.children_offset = offset;
     }
-    breakpoints_from_ancestors.insert(node->new_breakpoints.begin(),
-                                      node->new_breakpoints.end());
+    n.children_capacity = capacity;
+  }
 
-    for (auto ch : node->children) {
-      update_new_breakpoints(ch, breakpoints_from_ancestors);
+  void compact_children_pool() {
+    compacted_children_pool.clear();
+    for (auto &node : nodes) {
+      const size_t offset = compacted_children_pool.size();
+      compacted_children_pool.insert(
+          compacted_children_pool.end(),
+          children_pool.begin() + node.children_offset,
+          children_pool.begin() + node.children_offset +
+              node.children_capacity);
+      node.children_offset = offset;
     }
-    for (auto br : node->new_breakpoints) {
-      breakpoints_from_ancestors.erase(br);
+    children_pool.swap(compacted_children_pool);
+    unused_children_slots = 0;
+  }
+
+  uint32_t &get_breakpoint_multiplicity(Locus locus) {
+    if (locus >= breakpoint_multiplicity.size()) {
+      breakpoint_multiplicity.resize(2 * (locus + 1), 0);
     }
+    return breakpoint_multiplicity[locus];
   }
 
+  void add_path_breakpoints(NodeHandle node, int32_t delta) {
+    if (node != ROOT) {
+      get_breakpoint_multiplicity(nodes[node].label.first) += delta;
+      get_breakpoint_multiplicity(nodes[node].label.second) += delta;
+    }
+  }
+
+  /**
+   * Updates @new_breakpoints lists for nodes in subtree rooted at
+   * @subtree_root. Breakpoints inherited from ancestors are counted per locus
+   * along the path from the root, which is maintained while the subtree is
+   * traversed in depth first order.
+   */
   void update_new_breakpoints(NodeHandle subtree_root) {
-    std::unordered_set<Locus> found_breakpoints;
-    if (subtree_root->parent != nullptr) {
-      gather_ancestor_breakpoints(subtree_root->parent, found_breakpoints);
+    for (auto node = nodes[subtree_root].parent; node != NULL_NODE;
+         node = nodes[node].parent) {
+      add_path_breakpoints(node, 1);
+    }
+    breakpoints_path.clear();
+    const size_t end = get_subtree_end(subtree_root);
+    for (size_t i = nodes[subtree_root].preorder_position; i < end; i++) {
+      const NodeHandle node = preorder[i];
+      auto &n = nodes[node];
+      while (!breakpoints_path.empty() && breakpoints_path.back() != n.parent) {
+        add_path_breakpoints(breakpoints_path.back(), -1);
+        breakpoints_path.pop_back();
+      }
+      if (node != ROOT) {
+        n.new_breakpoints_count = 0;
+        for (Locus br : {n.label.first, n.label.second}) {
+          if (get_breakpoint_multiplicity(br) == 0) {
+            n.new_breakpoints[n.new_breakpoints_count++] = br;
+          }
+        }
+      }
+      add_path_breakpoints(node, 1);
+      breakpoints_path.push_back(node);
+    }
+    for (auto node : breakpoints_path) {
+      add_path_breakpoints(node, -1);
+    }
+    for (auto node = nodes[subtree_root].parent; node != NULL_NODE;
+         node = nodes[node].parent) {
+      add_path_breakpoints(node, -1);
     }
-    update_new_breakpoints(subtree_root, found_breakpoints);
   }
 
-  void collect_subtree_nodes(NodeHandle node, NodeVector &nodes) const {
-    nodes.push_back(node);
-    for (auto &child : node->children) {
-      collect_subtree_nodes(child, nodes);
+  void update_preorder_positions(size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      nodes[preorder[i]].preorder_position = i;
     }
   }
 
-  void detach_node(NodeHandle node) {
-    node->parent->children.remove(node);
-    node->parent = nullptr;
+  // Adds @delta to subtree sizes of @node and all its ancestors
+  void add_to_subtree_sizes(NodeHandle node, int32_t delta) {
+    for (; node != NULL_NODE; node = nodes[node].parent) {
+      nodes[node].subtree_size += delta;
+    }
   }
 
-  void attach_node(NodeHandle node, NodeHandle attach_to) {
-    node->parent = attach_to;
-    attach_to->children.push_back(node);
+  size_t get_subtree_end(NodeHandle node) const {
+    return nodes[node].preorder_position + nodes[node].subtree_size;
   }
 
   /**
-   * @brief Attach copy of subtree rooted at @tree_root to @parent
+   * Makes subtree rooted at @node the last subtree of @new_parent, which must
+   * not belong to it.
    */
-  void copy_subtree(NodeHandle parent, NodeHandle tree_root) {
-    NodeHandle new_node = create_detached_node(tree_root->label);
-    attach_node(new_node, parent);
-    for (auto child : tree_root->children) {
-      copy_subtree(new_node, child);
+  void move_subtree(NodeHandle node, NodeHandle new_parent) {
+    const size_t begin = nodes[node].preorder_position;
+    const size_t size = nodes[node].subtree_size;
+    // The subtree goes right after the last descendant of @new_parent
+    const size_t target = get_subtree_end(new_parent);
+    add_to_subtree_sizes(nodes[node].parent, -(int32_t)size);
+    detach_node(node);
+    attach_node(node, new_parent);
+    add_to_subtree_sizes(new_parent, size);
+    auto order = preorder.begin();
+    if (target <= begin) {
+      std::rotate(order + target, order + begin, order + begin + size);
+      update_preorder_positions(target, begin + size);
+    } else {
+      std::rotate(order + begin, order + begin + size, order + target);
+      update_preorder_positions(begin, target);
     }
   }
 
-public:
-  EventTree(const EventTree &tree) {
-    this->size = tree.size;
-    root = new Node();
-    for (auto child : tree.root->children) {
-      copy_subtree(root, child);
-    }
-    update_new_breakpoints(root);
+  void detach_node(NodeHandle node) {
+    auto &parent = nodes[nodes[node].parent];
+    auto begin = children_begin(nodes[node].parent);
+    auto end = begin + parent.children_count;
+    auto position = std::find(begin, end, node);
+    std::copy(position + 1, end, position);
+    parent.children_count--;
+    nodes[node].parent = NULL_NODE;
   }
 
-  EventTree &operator=(const EventTree &tree) {
-    this->size = tree.size;
-    if (root != nullptr) {
-      delete root;
+  void attach_node(NodeHandle node, NodeHandle attach_to) {
+    nodes[node].parent = attach_to;
+    if (nodes[attach_to].children_count ==
+        nodes[attach_to].children_capacity) {
+      grow_children_block(attach_to);
     }
-    root = new Node();
-    for (auto child : tree.root->children) {
-      copy_subtree(root, child);
+    auto &parent = nodes[attach_to];
+    children_pool[parent.children_offset + parent.children_count++] = node;
+    if (unused_children_slots > MIN_COMPACTED_SLOTS &&
+        2 * unused_children_slots > children_pool.size()) {
+      compact_children_pool();
     }
-    update_new_breakpoints(root);
-    return *this;
   }
 
-  EventTree() { root = new Node(); }
+public:
+  EventTree() = default;
 
-  ~EventTree() {
-    if (root != nullptr) {
-      delete root;
-    }
+  /**
+   * Copies only the tree structure. Scratch buffers of the copy are left
+   * empty, they are grown on demand.
+   */
+  EventTree(const EventTree &other)
+      : size{other.size}, nodes{other.nodes},
+        children_pool{other.children_pool},
+        unused_children_slots{other.unused_children_slots},
+        free_ids{other.free_ids}, preorder{other.preorder} {}
+
+  /**
+   * Copies only the tree structure, scratch buffers are kept.
+   */
+  EventTree &operator=(const EventTree &other) {
+    size = other.size;
+    nodes = other.nodes;
+    children_pool = other.children_pool;
+    unused_children_slots = other.unused_children_slots;
+    free_ids = other.free_ids;
+    preorder = other.preorder;
+    return *this;
   }
 
+  EventTree(EventTree &&) = default;
+  EventTree &operator=(EventTree &&) = default;
+
   bool is_leaf(NodeHandle node) const {
-    return node->children.size() == 0 && node != root;
+    return nodes[node].children_count == 0 && node != ROOT;
   }
 
   size_t get_size() const { return size; }
 
-  NodeHandle get_root() const { return root; }
+  NodeHandle get_root() const { return ROOT; }
 
-  NodeHandle get_parent(NodeHandle node) const { return node->parent; }
+  NodeHandle get_parent(NodeHandle node) const { return nodes[node].parent; }
 
-  const std::list<NodeHandle> get_children(const NodeHandle node) const {
-    return node->children;
+  /**
+   * Children of @node in the order of their attachment, without copying.
+   */
+  Range<NodeHandle> get_children(const NodeHandle node) const {
+    auto begin = children_pool.data() + nodes[node].children_offset;
+    return Range<NodeHandle>(begin, begin + nodes[node].children_count);
   }
 
-  std::list<Locus> const &get_new_breakpoints(const NodeHandle node) const {
-    return node->new_breakpoints;
+  Range<Locus> get_new_breakpoints(const NodeHandle node) const {
+    auto begin = nodes[node].new_breakpoints.data();
+    return Range<Locus>(begin, begin + nodes[node].new_breakpoints_count);
   }
 
   Event get_node_event(const NodeHandle node) const {
-    return get_event_from_label(node->label);
+    return get_event_from_label(nodes[node].label);
   }
 
-  TreeLabel get_node_label(const NodeHandle node) const { return node->label; }
+  TreeLabel get_node_label(const NodeHandle node) const {
+    return nodes[node].label;
+  }
+
+  /**
+   * Small integer, unique among nodes of the tree and constant during the
+   * lifetime of the node. Root has id 0. It is equal to the node handle.
+   */
+  size_t get_node_id(const NodeHandle node) const { return node; }
+
+  /**
+   * Returns number which is larger than ids of all nodes of the tree, per
+   * node data may be kept in arrays of this size.
+   */
+  size_t get_node_id_bound() const { return nodes.size(); }
+
+  /**
+   * Returns node with label @label or NULL_NODE if there is no such node.
+   */
+  NodeHandle find_node(TreeLabel label) const {
+    for (auto node : preorder) {
+      if (nodes[node].label == label) {
+        return node;
+      }
+    }
+    return NULL_NODE;
+  }
+
+  /**
+   * True if @node belongs to the subtree rooted at @ancestor, which includes
+   * @ancestor itself.
+   */
+  bool is_descendant(NodeHandle node, NodeHandle ancestor) const {
+    return nodes[ancestor].preorder_position <= nodes[node].preorder_position &&
+           nodes[node].preorder_position < get_subtree_end(ancestor);
+  }
 
   /*
           Returns -1 if @node1 is a descendant of @node2
@@ -184,19 +376,13 @@ public:
           0 otherwise
   */
   int get_nodes_relation(NodeHandle node1, NodeHandle node2) const {
-    auto node = node1->parent;
-    while (node != nullptr) {
-      if (node2 == node)
-        return -1;
-      node = node->parent;
+    if (node1 == node2) {
+      return 0;
     }
-    node = node2->parent;
-    while (node != nullptr) {
-      if (node1 == node)
-        return 1;
-      node = node->parent;
+    if (is_descendant(node1, node2)) {
+      return -1;
     }
-    return 0;
+    return is_descendant(node2, node1) ? 1 : 0;
   }
 
   /**
@@ -204,13 +390,34 @@ public:
    * included.
    */
   std::vector<NodeHandle> get_non_descendants(NodeHandle node) const {
-    std::vector<NodeHandle> all_nodes = get_descendants(root);
-    std::list<NodeHandle> non_descendants{all_nodes.begin(), all_nodes.end()};
-    for (auto d : get_descendants(node)) {
-      non_descendants.remove(d);
-    }
-    return std::vector<NodeHandle>(non_descendants.begin(),
-                                   non_descendants.end());
+    std::vector<NodeHandle> result;
+    get_non_descendants(node, result);
+    return result;
+  }
+
+  /**
+   * @brief Replaces content of @result with the result of
+   * <code>get_non_descendants(node)</code>, reusing its memory.
+   */
+  void get_non_descendants(NodeHandle node,
+                           std::vector<NodeHandle> &result) const {
+    result.assign(preorder.begin(),
+                  preorder.begin() + nodes[node].preorder_position);
+    result.insert(result.end(), preorder.begin() + get_subtree_end(node),
+                  preorder.end());
+  }
+
+  size_t count_non_descendants(NodeHandle node) const {
+    return size - nodes[node].subtree_size;
+  }
+
+  /**
+   * @brief Returns element @n of <code>get_non_descendants(node)</code>.
+   */
+  NodeHandle get_nth_non_descendant(NodeHandle node, size_t n) const {
+    return n < nodes[node].preorder_position
+               ? preorder[n]
+               : preorder[n + nodes[node].subtree_size];
   }
 
   /**
@@ -219,34 +426,58 @@ public:
    */
   std::vector<NodeHandle> get_descendants(NodeHandle node) const {
     std::vector<NodeHandle> result;
-    collect_subtree_nodes(node, result);
+    get_descendants(node, result);
     return result;
   }
 
+  /**
+   * @brief Replaces content of @result with the result of
+   * <code>get_descendants(node)</code>, reusing its memory.
+   */
+  void get_descendants(NodeHandle node,
+                       std::vector<NodeHandle> &result) const {
+    result.assign(preorder.begin() + nodes[node].preorder_position,
+                  preorder.begin() + get_subtree_end(node));
+  }
+
+  /**
+   * @brief Number of nodes in subtree rooted at @node, @node included.
+   */
+  size_t count_descendants(NodeHandle node) const {
+    return nodes[node].subtree_size;
+  }
+
+  /**
+   * @brief Returns element @n of <code>get_descendants(node)</code>.
+   */
+  NodeHandle get_nth_descendant(NodeHandle node, size_t n) const {
+    return preorder[nodes[node].preorder_position + n];
+  }
+
   std::vector<Event> get_all_events() const {
-    auto nodes = get_descendants(root);
-    nodes.erase(
-        std::remove_if(nodes.begin(), nodes.end(),
-                       [this](NodeHandle n) { return n == this->root; }));
+    auto all_nodes = get_descendants(ROOT);
+    all_nodes.erase(std::remove(all_nodes.begin(), all_nodes.end(), ROOT));
     std::vector<Event> events;
     std::transform(
-        nodes.begin(), nodes.end(), std::back_inserter(events),
+        all_nodes.begin(), all_nodes.end(), std::back_inserter(events),
         [this](NodeHandle n) -> Event { return this->get_node_event(n); });
     return events;
   }
 
   /**
    * @brief Recursively removes leaves of subtree rooted at @node which have no
-   * attached cell.
+   * attached cell. Cells are matched with nodes by node ids.
    */
   void prune_tree(NodeHandle node, Attachment &attachment) {
     // Node children may be modified while traversing it, that's why we iterate
     // on copy
-    auto node_children_copy = node->children;
+    auto children = get_children(node);
+    NodeVector node_children_copy{children.begin(), children.end()};
     for (auto child : node_children_copy) {
       prune_tree(child, attachment);
     }
-    if (node->children.empty() && !attachment.has_attached_cells(node->label)) {
+    if (nodes[node].children_count == 0 &&
+        !attachment.has_attached_cells(get_node_id(node))) {
       this->delete_leaf(node);
     }
   }
@@ -263,8 +494,12 @@ public:
    * @return NodeHandle - handle to new node
    */
   NodeHandle add_leaf(NodeHandle parent, TreeLabel label) {
-    Node *new_node = create_detached_node(label);
+    NodeHandle new_node = create_detached_node(label);
+    const size_t position = get_subtree_end(parent);
     attach_node(new_node, parent);
+    add_to_subtree_sizes(parent, 1);
+    preorder.insert(preorder.begin() + position, new_node);
+    update_preorder_positions(position, preorder.size());
     update_new_breakpoints(new_node);
     size++;
     return new_node;
@@ -280,9 +515,8 @@ public:
    */
   NodeHandle prune_and_reattach(NodeHandle node_to_prune,
                                 NodeHandle node_to_attach) {
-    NodeHandle parent = node_to_prune->parent;
-    detach_node(node_to_prune);
-    attach_node(node_to_prune, node_to_attach);
+    NodeHandle parent = nodes[node_to_prune].parent;
+    move_subtree(node_to_prune, node_to_attach);
     update_new_breakpoints(node_to_prune);
     return parent;
   }
@@ -294,9 +528,15 @@ public:
    * @param node2 - will be given label of node @node1
    */
   void swap_labels(NodeHandle node1, NodeHandle node2) {
-    std::swap(node1->label, node2->label);
-    update_new_breakpoints(node1);
-    update_new_breakpoints(node2);
+    std::swap(nodes[node1].label, nodes[node2].label);
+    if (is_descendant(node2, node1)) {
+      update_new_breakpoints(node1);
+    } else if (is_descendant(node1, node2)) {
+      update_new_breakpoints(node2);
+    } else {
+      update_new_breakpoints(node1);
+      update_new_breakpoints(node2);
+    }
   }
 
   /**
@@ -306,10 +546,14 @@ public:
    * @return NodeHandle - parent of the deleted leaf
    */
   NodeHandle delete_leaf(NodeHandle node) {
-    auto parent = node->parent;
+    auto parent = nodes[node].parent;
+    const size_t position = nodes[node].preorder_position;
     detach_node(node);
+    add_to_subtree_sizes(parent, -1);
+    preorder.erase(preorder.begin() + position);
+    update_preorder_positions(position, preorder.size());
     size--;
-    delete node;
+    release_node(node);
     return parent;
   }
 
@@ -318,7 +562,7 @@ public:
    * Whether this will not result in node label duplication is up to the caller.
    */
   void change_label(NodeHandle node, Event new_label) {
-    node->label = new_label;
+    nodes[node].label = new_label;
     update_new_breakpoints(node);
   }
 
@@ -328,12 +572,11 @@ public:
    * It is assumed that @root1 is not a descendant of @root2 and vice versa.
    */
   void swap_subtrees_non_descendants(NodeHandle root1, NodeHandle root2) {
-    auto parent1 = root1->parent;
-    auto parent2 = root2->parent;
-    detach_node(root1);
-    detach_node(root2);
-    attach_node(root1, parent2);
-    attach_node(root2, parent1);
+    auto parent1 = nodes[root1].parent;
+    auto parent2 = nodes[root2].parent;
+    // @root2 is moved last, so it follows @root1 if both have the same parent
+    move_subtree(root1, parent2);
+    move_subtree(root2, parent1);
     update_new_breakpoints(root1);
     update_new_breakpoints(root2);
   }
@@ -347,10 +590,8 @@ public:
    */
   void swap_subtrees_descendants(NodeHandle parent, NodeHandle descendant,
                                  NodeHandle descendant_of_descendant) {
-    detach_node(descendant);
-    attach_node(descendant, parent->parent);
-    detach_node(parent);
-    attach_node(parent, descendant_of_descendant);
+    move_subtree(descendant, nodes[parent].parent);
+    move_subtree(parent, descendant_of_descendant);
     update_new_breakpoints(descendant);
   }
 };
@@ -1,6 +1,11 @@
 #ifndef COUNTS_SCORING_H
 #define COUNTS_SCORING_H
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
 #include "../input_data/input_data.h"
 #include "../parameters/parameters.h"
 #include "event_tree.h"
@@ -12,7 +17,9 @@ private:
   std::vector<std::vector<Real_t>> sum_counts;
   std::vector<std::vector<Real_t>> squared_counts;
   std::vector<Real_t> counts_score_length_of_bin;
-  Real_t all_bins_count;
+  Real_t all_bins_count{0.0};
+  // Upper bound on the log score of any tree and attachment
+  Real_t log_score_upper_bound{std::numeric_limits<Real_t>::infinity()};
 
   // Specifies which cell bin pairs have already bin assigned to a cluster
   std::vector<std::vector<bool>> bin_bitmap;
@@ -22,6 +29,8 @@ private:
   // Used for persisting clusters induced by nodes
   std::vector<std::vector<size_t>> clusters_cache;
   size_t cache_id = 0;
+  // Sorted cells attached to each node, indexed by node id
+  std::vector<std::vector<size_t>> node_to_cells;
 
   void save_clustering_in_cache(std::vector<size_t> &cluster, size_t cache_id) {
     if (cache_id >= clusters_cache.size()) {
@@ -52,39 +61,42 @@ private:
   /**
    * @brief Move all cells attached to @child to @parent
    */
-  void move_cells_to_parent(EventTree::NodeHandle child,
-                            EventTree::NodeHandle parent,
-                            std::map<Event, std::set<size_t>> &attachment) {
-    if (attachment.find(child->label) == attachment.end()) {
+  void move_cells_to_parent(EventTree &tree, EventTree::NodeHandle child,
+                            EventTree::NodeHandle parent) {
+    auto &child_cells = node_to_cells[tree.get_node_id(child)];
+    if (child_cells.empty()) {
       return;
     }
-    if (attachment.find(parent->label) == attachment.end()) {
-      attachment[parent->label] = std::set<size_t>();
-    }
-    attachment[parent->label].insert(attachment[child->label].begin(),
-                                     attachment[child->label].end());
-    attachment.erase(child->label);
+    auto &parent_cells = node_to_cells[tree.get_node_id(parent)];
+    const size_t parent_cells_count = parent_cells.size();
+    parent_cells.insert(parent_cells.end(), child_cells.begin(),
+                        child_cells.end());
+    std::inplace_merge(parent_cells.begin(),
+                       parent_cells.begin() + parent_cells_count,
+                       parent_cells.end());
+    child_cells.clear();
   }
 
-  Real_t calculate_penalty_for_bins_at_node(
-      EventTree::NodeHandle node,
-      std::map<Event, std::set<size_t>> &attachment) {
-    if (attachment.find(node->label) == attachment.end()) {
+  Real_t calculate_penalty_for_bins_at_node(EventTree &tree,
+                                            EventTree::NodeHandle node) {
+    auto &cells = node_to_cells[tree.get_node_id(node)];
+    if (cells.empty()) {
       return 0.0;
     }
     std::map<size_t, Real_t> cluster_to_counts_sum;
     std::map<size_t, Real_t> cluster_to_bin_count;
     std::map<size_t, Real_t> cluster_to_squared_counts_sum;
 
+    const auto label = tree.get_node_label(node);
     Real_t result = 0.0;
-    for (size_t i = node->label.first; i < node->label.second; i++) {
+    for (size_t i = label.first; i < label.second; i++) {
       cluster_to_counts_sum[event_clusters[i]] = 0.0;
       cluster_to_bin_count[event_clusters[i]] = 0.0;
       cluster_to_squared_counts_sum[event_clusters[i]] = 0.0;
     }
 
-    for (auto cell : attachment[node->label]) {
-      for (size_t bin = node->label.first; bin < node->label.second; bin++) {
+    for (auto cell : cells) {
+      for (size_t bin = label.first; bin < label.second; bin++) {
         if (!bin_bitmap[cell][bin]) {
           cluster_to_counts_sum[event_clusters[bin]] += sum_counts[cell][bin];
           cluster_to_squared_counts_sum[event_clusters[bin]] +=
@@ -93,8 +105,8 @@ private:
               counts_score_length_of_bin[bin];
         }
       }
-      std::fill(bin_bitmap[cell].begin() + node->label.first,
-                bin_bitmap[cell].begin() + node->label.second, true);
+      std::fill(bin_bitmap[cell].begin() + label.first,
+                bin_bitmap[cell].begin() + label.second, true);
     }
 
     for (const auto &cluster : cluster_to_counts_sum) {
@@ -126,21 +138,20 @@ private:
     }
   }
 
-  Real_t calculate_penalty_for_non_root_bins(
-      EventTree::NodeHandle node,
-      std::map<Event, std::set<size_t>> &attachment) {
+  Real_t calculate_penalty_for_non_root_bins(EventTree &tree,
+                                             EventTree::NodeHandle node) {
     Real_t result = 0.0;
     auto node_cache_id = cache_id;
     cache_id++;
 
     save_clustering_in_cache(event_clusters, node_cache_id);
-    update_clusters(event_clusters, node->label);
+    update_clusters(event_clusters, tree.get_node_label(node));
 
-    for (auto child : node->children) {
-      result += calculate_penalty_for_non_root_bins(child, attachment);
-      move_cells_to_parent(child, node, attachment);
+    for (auto child : tree.get_children(node)) {
+      result += calculate_penalty_for_non_root_bins(tree, child);
+      move_cells_to_parent(tree, child, node);
     }
-    result += calculate_penalty_for_bins_at_node(node, attachment);
+    result += calculate_penalty_for_bins_at_node(tree, node);
 
     /* Restore clustering of parent */
     event_clusters = get_clustering_from_cache(node_cache_id);
@@ -183,13 +194,55 @@ private:
     cache_id = 0;
   }
 
+  /**
+   * Every bin of every cell is scored either in some cluster or at the root.
+   * Sums of squared counts bound squared sums from above (Cauchy-Schwarz), so
+   * penalty of a cluster is at least the sum of penalties of its bins scored
+   * separately. Hence the sum over bins of the smaller of the two possible
+   * penalties bounds the total penalty from below, if both constants are
+   * nonnegative.
+   */
+  void calculate_log_score_upper_bound() {
+    if (COUNTS_SCORE_CONSTANT_0 < 0.0 || COUNTS_SCORE_CONSTANT_1 < 0.0 ||
+        *std::min_element(counts_score_length_of_bin.begin(),
+                          counts_score_length_of_bin.end()) <= 0.0) {
+      return;
+    }
+    Real_t penalty_lower_bound = 0.0;
+    Real_t penalty_magnitude = 0.0;
+    for (size_t cell = 0; cell < sum_counts.size(); cell++) {
+      for (size_t bin = 0; bin < counts_score_length_of_bin.size(); bin++) {
+        auto length = counts_score_length_of_bin[bin];
+        auto cluster_penalty =
+            COUNTS_SCORE_CONSTANT_0 *
+            calculate_l2_penalty(sum_counts[cell][bin] / length,
+                                 sum_counts[cell][bin],
+                                 squared_counts[cell][bin], length,
+                                 all_bins_count);
+        auto root_penalty =
+            COUNTS_SCORE_CONSTANT_1 *
+            calculate_l2_penalty(NEUTRAL_CN, sum_counts[cell][bin],
+                                 squared_counts[cell][bin], length,
+                                 all_bins_count);
+        penalty_lower_bound += std::min(cluster_penalty, root_penalty);
+        penalty_magnitude += std::abs(cluster_penalty) +
+                             std::abs(root_penalty) +
+                             squared_counts[cell][bin] / all_bins_count;
+      }
+    }
+    // Margin for rounding errors of the exact calculation
+    log_score_upper_bound =
+        -penalty_lower_bound +
+        std::sqrt(std::numeric_limits<Real_t>::epsilon()) *
+            (1.0 + penalty_magnitude);
+  }
+
   Real_t calculate_log_score__(EventTree &tree, Attachment &at) {
     init_state();
-    std::map<Event, std::set<size_t>> attachment =
-        at.get_node_label_to_cells_map();
+    at.get_node_id_to_cells(node_to_cells, tree.get_node_id_bound());
     Real_t result = 0.0;
     for (auto node : tree.get_children(tree.get_root())) {
-      result += calculate_penalty_for_non_root_bins(node, attachment);
+      result += calculate_penalty_for_non_root_bins(tree, node);
     }
     return -(result + calculate_penalty_for_bins_at_root());
   }
@@ -212,6 +265,18 @@ public:
 
     all_bins_count *= cells.get_cells_count();
     clusters_cache.resize(DEFAULT_CACHE_SIZE);
+    calculate_log_score_upper_bound();
+  }
+
+  /**
+   * Returns a number not smaller than the log score of any tree and
+   * attachment, infinity if no bound is known.
+   */
+  Real_t get_log_score_upper_bound() const {
+    if (COUNTS_SCORE_CONSTANT_0 == 0.0 && COUNTS_SCORE_CONSTANT_1 == 0) {
+      return 0.0;
+    }
+    return log_score_upper_bound;
   }
 
   Real_t calculate_log_score(EventTree &tree, Attachment &at) {
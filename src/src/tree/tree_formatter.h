@@ -15,12 +15,12 @@ class TreeFormatter {
 
   static std::string get_node_label(EventTree &tree, NodeHandle node) {
     return node == tree.get_root() ? get_root_string_rep()
-                                   : label_to_str(node->label);
+                                   : label_to_str(tree.get_node_label(node));
   }
 
   static void to_string(EventTree &tree, NodeHandle node,
                         std::stringstream &ss) {
-    for (auto &child : node->children) {
+    for (auto child : tree.get_children(node)) {
       ss << get_node_label(tree, node) << "-" << get_node_label(tree, child)
          << "\n";
       to_string(tree, child, ss);
@@ -3,36 +3,68 @@
 
 #include "../tree/event_tree.h"
 #include "../utils/logger/logger.h"
-#include <algorithm>
+#include <limits>
+#include <vector>
 
 /**
- * @brief This class is responsible for sampling of EventTree nodes.
+ * @brief Set of tree nodes with O(1) insertion, removal and uniform access.
+ *
+ * Positions of members are indexed by node handles. Removed node is replaced
+ * by the last member, so the order of members depends on the history of
+ * changes.
  */
-template <class Real_t> class TreeNodeSampler {
+class IndexedNodeSet {
 private:
   using NodeHandle = EventTree::NodeHandle;
-  using NodeVector = std::vector<NodeHandle>;
+  static constexpr uint32_t ABSENT = std::numeric_limits<uint32_t>::max();
 
-  EventTree &tree;
-  NodeVector leaves;
-  NodeVector nodes;
+  std::vector<NodeHandle> members;
+  std::vector<uint32_t> positions;
 
-  void erase_from_vector(NodeVector &vec, NodeHandle node) const {
-    vec.erase(std::remove_if(vec.begin(), vec.end(),
-                             [node](NodeHandle n) { return n == node; }));
+public:
+  bool contains(NodeHandle node) const {
+    return node < positions.size() && positions[node] != ABSENT;
   }
 
-  bool find(NodeVector &vec, NodeHandle node) {
-    return std::find(vec.begin(), vec.end(), node) != vec.end();
+  void insert(NodeHandle node) {
+    if (contains(node)) {
+      return;
+    }
+    if (node >= positions.size()) {
+      positions.resize(node + 1, ABSENT);
+    }
+    positions[node] = members.size();
+    members.push_back(node);
   }
 
-  void remove_node(NodeHandle node) {
-    erase_from_vector(nodes, node);
-    if (tree.is_leaf(node)) {
-      erase_from_vector(leaves, node);
+  void erase(NodeHandle node) {
+    if (!contains(node)) {
+      return;
     }
+    const auto last = members.back();
+    members[positions[node]] = last;
+    positions[last] = positions[node];
+    positions[node] = ABSENT;
+    members.pop_back();
   }
 
+  NodeHandle operator[](size_t i) const { return members[i]; }
+
+  size_t size() const { return members.size(); }
+};
+
+/**
+ * @brief This class is responsible for sampling of EventTree nodes.
+ */
+template <class Real_t> class TreeNodeSampler {
+private:
+  using NodeHandle = EventTree::NodeHandle;
+
+  EventTree &tree;
+  IndexedNodeSet leaves;
+  // All nodes except the root
+  IndexedNodeSet nodes;
+
 public:
   TreeNodeSampler(EventTree &tree) : tree{tree} {
     for (auto node : tree.get_descendants(tree.get_root())) {
@@ -42,6 +74,15 @@ public:
     }
   }
 
+  /**
+   * Creates sampler for @tree, which is a copy of the tree of @other. Nodes
+   * are kept in the same order as in @other, so that both samplers return
+   * corresponding nodes for the same random numbers. Copies of the tree have
+   * the same node handles.
+   */
+  TreeNodeSampler(EventTree &tree, const TreeNodeSampler<Real_t> &other)
+      : tree{tree}, leaves{other.leaves}, nodes{other.nodes} {}
+
   NodeHandle sample_node(bool with_root, Random<Real_t> &random) {
     size_t bound = with_root ? nodes.size() + 1 : nodes.size();
     size_t node = random.next_int(bound);
@@ -53,13 +94,13 @@ public:
   }
 
   NodeHandle sample_non_descendant(NodeHandle node, Random<Real_t> &random) {
-    auto nonDescendants = std::move(tree.get_non_descendants(node));
-    return nonDescendants[random.next_int(nonDescendants.size())];
+    return tree.get_nth_non_descendant(
+        node, random.next_int(tree.count_non_descendants(node)));
   }
 
   NodeHandle sample_descendant(NodeHandle node, Random<Real_t> &random) {
-    auto descendants = std::move(tree.get_descendants(node));
-    return descendants[random.next_int(descendants.size())];
+    return tree.get_nth_descendant(
+        node, random.next_int(tree.count_descendants(node)));
   }
 
   std::pair<NodeHandle, NodeHandle> sample_nodes_pair(Random<Real_t> &random) {
@@ -72,22 +113,19 @@ public:
   }
 
   void delete_leaf(NodeHandle node) {
-    erase_from_vector(nodes, node);
-    erase_from_vector(leaves, node);
+    nodes.erase(node);
+    leaves.erase(node);
   }
 
   void refresh_node_data(const NodeHandle node) {
-    if (node == nullptr || node == tree.get_root()) {
+    if (node == EventTree::NULL_NODE || node == tree.get_root()) {
       return;
     }
-    if (!find(nodes, node)) {
-      nodes.push_back(node);
-    }
-    if (tree.is_leaf(node) && !find(leaves, node)) {
-      leaves.push_back(node);
-    }
-    if (!tree.is_leaf(node) && find(leaves, node)) {
-      erase_from_vector(leaves, node);
+    nodes.insert(node);
+    if (tree.is_leaf(node)) {
+      leaves.insert(node);
+    } else {
+      leaves.erase(node);
     }
   }
 
@@ -96,10 +134,15 @@ public:
   Real_t get_delete_leaf_kernel() { return -std::log((Real_t)leaves.size()); }
 
   Real_t get_swap_subtrees_descendants_kernel(NodeHandle node) {
-    return -std::log((Real_t)tree.get_descendants(node).size());
+    return -std::log((Real_t)tree.count_descendants(node));
   }
 
-  size_t count_leaves() { return leaves.size(); }
+  size_t count_leaves() const { return leaves.size(); }
+
+  /**
+   * @brief Number of nodes which may be sampled, the root excluded.
+   */
+  size_t count_nodes() const { return nodes.size(); }
 };
 
 #endif // !NODE_SAMPLER_H
@@ -2,6 +2,7 @@
 #define EVENT_CONTAINER_H
 
 #include "../../types.h"
+#include <algorithm>
 #include <vector>
 /**
  * Container for storing ordered pairs of positive integers.
@@ -13,30 +14,34 @@
  *
  * Internally each pair is converted into an index and marked in a bitmap.
  * For fast element retrieval pairs with given first coordinate are counted.
+ * If <code>max_span</code> is set only pairs with <code>y - x <=
+ * max_span</code> may be stored and the bitmap is limited to them.
  */
 class EventContainer {
   size_t max_locus;
+  size_t max_span;
   size_t size_{0};
   std::vector<size_t> first_event_loci;
   std::vector<bool> event_bit_map;
 
   size_t get_event_index(Event ev) const {
-    return ev.first * (max_locus + 1) + ev.second;
+    return ev.first * max_span + (ev.second - ev.first - 1);
   }
 
   Event get_by_index(size_t index) const {
-    return std::make_pair(index / (max_locus + 1), index % (max_locus + 1));
+    const size_t first = index / max_span;
+    return std::make_pair(first, first + index % max_span + 1);
   }
 
   void init() {
-    event_bit_map.resize((max_locus + 1) * (max_locus + 1));
+    event_bit_map.resize((max_locus + 1) * max_span);
     first_event_loci.resize(max_locus + 1);
     std::fill(event_bit_map.begin(), event_bit_map.end(), false);
     std::fill(first_event_loci.begin(), first_event_loci.end(), 0);
   }
 
   Event get_nth(Locus first_locus, size_t n) const {
-    size_t i = get_event_index(std::make_pair(first_locus, 0));
+    size_t i = first_locus * max_span;
     size_t found = -1;
     while (found != n) {
       if (event_bit_map[i] == true) {
@@ -48,7 +53,11 @@ class EventContainer {
   }
 
 public:
-  EventContainer(size_t max_locus) : max_locus{max_locus} { init(); }
+  EventContainer(size_t max_locus, size_t max_span = 0)
+      : max_locus{max_locus},
+        max_span{max_span == 0 ? std::max(max_locus, (size_t)1) : max_span} {
+    init();
+  }
 
   bool empty() const { return this->size_ == 0; }
 
@@ -66,7 +75,10 @@ public:
     event_bit_map[get_event_index(brkp)] = false;
   }
 
-  bool find(Event brkp) { return event_bit_map[get_event_index(brkp)]; }
+  bool find(Event brkp) {
+    return is_valid_event(brkp) && brkp.second - brkp.first <= max_span &&
+           event_bit_map[get_event_index(brkp)];
+  }
 
   Event get_nth(size_t n) const {
     size_t first = 0;
@@ -1,19 +1,46 @@
 #ifndef VERTEX_SAMPLER_H
 #define VERTEX_SAMPLER_H
 #include <algorithm>
+#include <cmath>
+#include <vector>
 
+#include "../input_data/input_data.h"
+#include "../parameters/parameters.h"
+#include "../utils/alias_table.h"
 #include "../utils/logger/logger.h"
 #include "../utils/random.h"
 #include "./utils/event_container.h"
 
 /**
- * This class is responsible for sampling labels for new tree vertices
+ * This class is responsible for sampling labels for new tree vertices.
+ *
+ * Labels are sampled uniformly from unused labels, unless locus weights are
+ * set. Then label <code>(a, b)</code> is sampled with probability
+ * proportional to <code>w[a] * w[b]</code>.
+ *
+ * Label universe may be limited to events not longer than
+ * <code>MAX_EVENT_LOCI</code> loci and <code>MAX_EVENT_LENGTH</code> genomic
+ * length. Labels outside of it are never sampled.
  */
 template <class Real_t> class VertexLabelSampler {
 private:
   Locus max_loci;
-  EventContainer unused_labels;
   std::vector<Locus> chromosome_end_markers;
+  // Smallest locus which can't be the end of a label starting at the index
+  std::vector<Locus> labels_ends;
+  EventContainer unused_labels;
+
+  // Informed proposals state, see set_locus_weights
+  bool informed{false};
+  std::vector<Real_t> locus_weights;
+  // Sums of weights of loci smaller than the index
+  std::vector<Real_t> locus_weights_prefix_sums;
+  // Samples the first locus of a label with probability proportional to the
+  // summed weight of valid labels starting at it
+  AliasTable<Real_t> first_locus_table;
+  // Kept in double precision, as single label weights may be below float
+  // resolution of the sum and its updates would drift
+  double unused_labels_weight{0.0};
 
   size_t get_locus_chromosome(Locus locus) {
     size_t chromosome = 0;
@@ -24,37 +51,187 @@ private:
   }
 
   bool is_valid_label(TreeLabel brkp) {
-    return is_valid_event(brkp) && get_locus_chromosome(brkp.first) ==
-                                       get_locus_chromosome(brkp.second);
+    return is_valid_event(brkp) && brkp.second < labels_ends[brkp.first];
+  }
+
+  Locus get_labels_end(Locus locus) { return labels_ends[locus]; }
+
+  /**
+   * @loci_lengths - genomic length of each locus, empty if @max_length is 0
+   */
+  void init_labels_ends(size_t max_loci_span, Real_t max_length,
+                        const std::vector<Real_t> &loci_lengths) {
+    labels_ends.resize(max_loci + 1);
+    for (Locus l = 0; l <= max_loci; l++) {
+      labels_ends[l] = std::min(
+          chromosome_end_markers[get_locus_chromosome(l)], max_loci + 1);
+      if (max_loci_span > 0) {
+        labels_ends[l] = std::min(labels_ends[l], l + max_loci_span + 1);
+      }
+      if (max_length > 0.0) {
+        Real_t length = 0.0;
+        Locus end = l + 1;
+        while (end < labels_ends[l] &&
+               length + loci_lengths[end - 1] <= max_length) {
+          length += loci_lengths[end - 1];
+          end++;
+        }
+        labels_ends[l] = end;
+      }
+    }
+  }
+
+  size_t get_max_span() const {
+    size_t span = 0;
+    for (Locus l = 0; l <= max_loci; l++) {
+      span = std::max(span, labels_ends[l] - l - 1);
+    }
+    return span;
+  }
+
+  double get_label_weight(TreeLabel label) const {
+    return (double)locus_weights[label.first] * locus_weights[label.second];
   }
 
   void init() {
     for (size_t brkp = 0; brkp <= max_loci; brkp++) {
-      for (size_t brkp2 = brkp + 1; brkp2 <= max_loci; brkp2++) {
-        if (is_valid_label(std::make_pair(brkp, brkp2))) {
-          unused_labels.insert(std::make_pair(brkp, brkp2));
-        }
+      for (size_t brkp2 = brkp + 1; brkp2 < labels_ends[brkp]; brkp2++) {
+        unused_labels.insert(std::make_pair(brkp, brkp2));
       }
     }
   }
 
+  VertexLabelSampler(size_t max_loci, std::vector<size_t> chr_markers,
+                     size_t max_loci_span, Real_t max_length,
+                     const std::vector<Real_t> &loci_lengths)
+      : max_loci{max_loci}, chromosome_end_markers{chr_markers},
+        unused_labels{0} {
+    init_labels_ends(max_loci_span, max_length, loci_lengths);
+    unused_labels = EventContainer(max_loci, get_max_span());
+    init();
+  }
+
+  static std::vector<Real_t>
+  get_loci_lengths(const CONETInputData<Real_t> &cells) {
+    std::vector<Real_t> lengths;
+    for (Locus l = 0; l + 1 < cells.get_loci_count(); l++) {
+      lengths.push_back(cells.get_event_length(std::make_pair(l, l + 1)));
+    }
+    return lengths;
+  }
+
 public:
+  /**
+   * Sampler of all labels with both breakpoints on the same chromosome.
+   */
   VertexLabelSampler(size_t max_loci, std::vector<size_t> chr_markers)
-      : max_loci{max_loci}, unused_labels{max_loci}, chromosome_end_markers{
-                                                         chr_markers} {
-    init();
+      : VertexLabelSampler(max_loci, chr_markers, 0, 0.0, {}) {}
+
+  /**
+   * Sampler of labels for loci of @cells, limited by
+   * <code>MAX_EVENT_LOCI</code> and <code>MAX_EVENT_LENGTH</code>.
+   */
+  explicit VertexLabelSampler(const CONETInputData<Real_t> &cells)
+      : VertexLabelSampler(cells.get_loci_count() - 1,
+                           cells.get_chromosome_end_markers(), MAX_EVENT_LOCI,
+                           (Real_t)MAX_EVENT_LENGTH, get_loci_lengths(cells)) {
+  }
+
+  void add_label(TreeLabel l) {
+    unused_labels.erase(l);
+    if (informed) {
+      unused_labels_weight -= get_label_weight(l);
+    }
   }
 
-  void add_label(TreeLabel l) { unused_labels.erase(l); }
+  void remove_label(TreeLabel l) {
+    unused_labels.insert(l);
+    if (informed) {
+      unused_labels_weight += get_label_weight(l);
+    }
+  }
 
-  void remove_label(TreeLabel l) { unused_labels.insert(l); }
+  /**
+   * Switches to informed label sampling with positive @weights of loci.
+   * @used_labels must be all labels which are not free.
+   */
+  void set_locus_weights(std::vector<Real_t> weights,
+                         const std::vector<TreeLabel> &used_labels) {
+    informed = true;
+    locus_weights = weights;
+    locus_weights_prefix_sums.assign(max_loci + 2, 0.0);
+    for (Locus l = 0; l <= max_loci; l++) {
+      locus_weights_prefix_sums[l + 1] =
+          locus_weights_prefix_sums[l] + locus_weights[l];
+    }
+    std::vector<double> exact_prefix_sums(max_loci + 2, 0.0);
+    for (Locus l = 0; l <= max_loci; l++) {
+      exact_prefix_sums[l + 1] = exact_prefix_sums[l] + locus_weights[l];
+    }
+    std::vector<Real_t> first_locus_weights;
+    unused_labels_weight = 0.0;
+    for (Locus l = 0; l <= max_loci; l++) {
+      first_locus_weights.push_back(
+          locus_weights[l] * (locus_weights_prefix_sums[get_labels_end(l)] -
+                              locus_weights_prefix_sums[l + 1]));
+      unused_labels_weight +=
+          locus_weights[l] *
+          (exact_prefix_sums[get_labels_end(l)] - exact_prefix_sums[l + 1]);
+    }
+    first_locus_table = AliasTable<Real_t>(first_locus_weights);
+    for (auto label : used_labels) {
+      unused_labels_weight -= get_label_weight(label);
+    }
+  }
 
+  /**
+   * Log of the probability of each label under uniform sampling. It does not
+   * depend on locus weights and is a part of the tree prior.
+   */
   Real_t get_sample_label_log_kernel() {
     return -std::log((Real_t)unused_labels.size());
   }
 
+  /**
+   * Log of the probability that <code>sample_label</code> returns @label,
+   * calculated as if @label was not used.
+   */
+  Real_t get_sample_label_log_kernel(TreeLabel label) {
+    const bool used = !unused_labels.find(label);
+    if (!informed) {
+      return -std::log((Real_t)unused_labels.size() + (used ? 1 : 0));
+    }
+    const double weight = get_label_weight(label);
+    return (Real_t)(std::log(weight) -
+                    std::log(unused_labels_weight + (used ? weight : 0.0)));
+  }
+
+  /**
+   * Sum of weights of unused labels, normaliser of informed kernels.
+   */
+  double get_unused_labels_weight() const { return unused_labels_weight; }
+
   TreeLabel sample_label(Random<Real_t> &random) {
-    return unused_labels.get_nth(random.next_int(unused_labels.size()));
+    if (!informed) {
+      return unused_labels.get_nth(random.next_int(unused_labels.size()));
+    }
+    // Rejection sampling from all valid labels, used labels are rare
+    while (true) {
+      const Locus first = first_locus_table.sample(random);
+      const Locus end = get_labels_end(first);
+      const Real_t from = locus_weights_prefix_sums[first + 1];
+      const Real_t target =
+          from + random.uniform() * (locus_weights_prefix_sums[end] - from);
+      Locus second =
+          std::upper_bound(locus_weights_prefix_sums.begin() + first + 1,
+                           locus_weights_prefix_sums.begin() + end, target) -
+          locus_weights_prefix_sums.begin() - 1;
+      second = std::max(first + 1, std::min(second, end - 1));
+      auto label = std::make_pair(first, second);
+      if (unused_labels.find(label)) {
+        return label;
+      }
+    }
   }
 
   bool has_free_labels() { return !unused_labels.empty(); }
@@ -1,10 +1,13 @@
 #ifndef TREE_MH_STEPS_EXECUTOR_H
-#define TREE_MH_STEPS_EXECUTOR_
+#define TREE_MH_STEPS_EXECUTOR_H
+#include <array>
+#include <variant>
 #include <vector>
 
 #include "input_data/input_data.h"
 #include "likelihood_coordinator.h"
 #include "moves/move_type.h"
+#include "tree/attachment.h"
 #include "tree/event_tree.h"
 #include "tree/tree_node_sampler.h"
 #include "tree/vertex_label_sampler.h"
@@ -17,28 +20,143 @@ template <class Real_t> class MHStepsExecutor {
   using NodeHandle = EventTree::NodeHandle;
 
 public:
+  /**
+   * Nodes involved in a move, one struct for each kind of move. Handles are
+   * visited by <code>for_each</code> in a fixed order.
+   */
+  struct AddedLeaf {
+    NodeHandle added_leaf{EventTree::NULL_NODE};
+    template <class F> void for_each(F &f) { f(added_leaf); }
+  };
+  struct DeletedLeaf {
+    NodeHandle leaf_parent{EventTree::NULL_NODE};
+    template <class F> void for_each(F &f) { f(leaf_parent); }
+  };
+  struct ChangedNode {
+    NodeHandle node{EventTree::NULL_NODE};
+    template <class F> void for_each(F &f) { f(node); }
+  };
+  // SWAP_LABELS, SWAP_ONE_BREAKPOINT and swap of non descendant subtrees
+  struct NodesPair {
+    NodeHandle node1{EventTree::NULL_NODE};
+    NodeHandle node2{EventTree::NULL_NODE};
+    template <class F> void for_each(F &f) {
+      f(node1);
+      f(node2);
+    }
+  };
+  struct PrunedSubtree {
+    NodeHandle prunned_root{EventTree::NULL_NODE};
+    NodeHandle old_subtree_parent{EventTree::NULL_NODE};
+    template <class F> void for_each(F &f) {
+      f(prunned_root);
+      f(old_subtree_parent);
+    }
+  };
+  struct SwappedDescendants {
+    NodeHandle middle_node{EventTree::NULL_NODE};
+    NodeHandle first_node{EventTree::NULL_NODE};
+    NodeHandle parent_of_middle_node{EventTree::NULL_NODE};
+    template <class F> void for_each(F &f) {
+      f(middle_node);
+      f(first_node);
+      f(parent_of_middle_node);
+    }
+  };
+  using MoveNodes = std::variant<AddedLeaf, DeletedLeaf, ChangedNode,
+                                 NodesPair, PrunedSubtree, SwappedDescendants>;
+
   struct MoveData {
     /**
      * This class is used to persist move data so that move reversal is possible
-     * only based on this class instance
+     * only based on this class instance. It does not allocate memory.
      */
-    std::map<std::string, NodeHandle> nodes;
+    MoveNodes nodes;
     TreeLabel label;
+    // Used by SWAP_ONE_BREAKPOINT only
+    TreeLabel second_label;
+    int left{0};
+    int right{0};
     bool boolean_flag;
     Real_t move_log_kernel{1.0};
     Real_t reverse_move_log_kernel{1.0};
+    // True if the reverse kernel depends on attachment of cells to the tree
+    // after the move, see complete_reverse_move_log_kernel
+    bool informed{false};
 
     MoveData()
-        : label{get_root_label()}, boolean_flag{false}, move_log_kernel{1.0},
+        : label{get_root_label()}, second_label{get_root_label()},
+          boolean_flag{false}, move_log_kernel{1.0},
           reverse_move_log_kernel{1.0} {}
   };
 
+  /**
+   * Labels of nodes referenced by MoveData, in the order of
+   * <code>for_each</code>.
+   */
+  struct MoveLabels {
+    std::array<TreeLabel, 3> labels;
+    size_t size{0};
+  };
+
+  /**
+   * Executed move described by labels of the involved nodes. Labels are
+   * unique in the tree, so the move can be replayed on a copy of the tree.
+   */
+  struct MoveReplay {
+    MoveType type{ADD_LEAF};
+    std::vector<TreeLabel> labels;
+    bool boolean_flag{false};
+    int left{0};
+    int right{0};
+  };
+
 private:
   EventTree &tree;
   VertexLabelSampler<Real_t> label_sampler;
   TreeNodeSampler<Real_t> node_sampler;
   CONETInputData<Real_t> &cells;
   Random<Real_t> &random;
+  bool informed_labels{false};
+  // Sum of lengths of all events of the tree, updated by each label change
+  double events_length{0.0};
+
+  // Informed reattachment state, see enable_informed_reattachment
+  std::vector<std::vector<bool>> breakpoint_support;
+  const Attachment *attachment{nullptr};
+  // Buffers reused by consecutive moves
+  std::vector<NodeHandle> reattachment_targets;
+  std::vector<Real_t> reattachment_weights;
+
+  /**
+   * Sets @reattachment_targets to non descendants of @node and
+   * @reattachment_weights to weights of its reattachment to each of them:
+   * one plus the number of breakpoints of @node supported by cells attached
+   * to the target according to @at.
+   */
+  void calculate_reattachment_weights(NodeHandle node, const Attachment &at) {
+    tree.get_non_descendants(node, reattachment_targets);
+    auto label = tree.get_node_label(node);
+    auto &first_support = breakpoint_support[label.first];
+    auto &second_support = breakpoint_support[label.second];
+    reattachment_weights.clear();
+    for (auto target : reattachment_targets) {
+      size_t supported = 0;
+      for (auto cell : at.get_attached_cells(tree.get_node_id(target))) {
+        supported += first_support[cell] + second_support[cell];
+      }
+      reattachment_weights.push_back(1.0 + supported);
+    }
+  }
+
+  static Real_t get_log_weight_fraction(const std::vector<Real_t> &weights,
+                                        size_t index) {
+    Real_t weights_sum = 0.0;
+    for (auto w : weights) {
+      weights_sum += w;
+    }
+    return std::log(weights[index]) - std::log(weights_sum);
+  }
 
   void prune_and_reattach(NodeHandle node_to_prune,
                           NodeHandle attachment_node) {
@@ -55,6 +173,7 @@ private:
   NodeHandle delete_leaf(NodeHandle node) {
     node_sampler.delete_leaf(node);
     label_sampler.remove_label(tree.get_node_label(node));
+    events_length -= cells.get_event_length(tree.get_node_label(node));
     auto parent = tree.delete_leaf(node);
     node_sampler.refresh_node_data(parent);
     return parent;
@@ -65,13 +184,16 @@ private:
     node_sampler.refresh_node_data(leaf);
     node_sampler.refresh_node_data(attachment_node);
     label_sampler.add_label(label);
+    events_length += cells.get_event_length(label);
     return leaf;
   }
 
   void change_label(NodeHandle node, TreeLabel new_label) {
     label_sampler.remove_label(tree.get_node_label(node));
+    events_length -= cells.get_event_length(tree.get_node_label(node));
     tree.change_label(node, new_label);
     label_sampler.add_label(new_label);
+    events_length += cells.get_event_length(new_label);
   }
 
   void swap_subtrees_non_descendants(NodeHandle root1, NodeHandle root2) {
@@ -100,8 +222,12 @@ private:
     }
     auto new_labels = label_sampler.swap_one_breakpoint(
         tree.get_node_event(node1), tree.get_node_event(node2), left, right);
+    events_length -= cells.get_event_length(tree.get_node_label(node1)) +
+                     cells.get_event_length(tree.get_node_label(node2));
     tree.change_label(node1, new_labels.first);
     tree.change_label(node2, new_labels.second);
+    events_length += cells.get_event_length(new_labels.first) +
+                     cells.get_event_length(new_labels.second);
   }
 
   MoveData delete_leaf_move() {
@@ -109,20 +235,21 @@ private:
     move_data.move_log_kernel = node_sampler.get_delete_leaf_kernel();
     auto leaf = node_sampler.sample_leaf(random);
     move_data.label = tree.get_node_label(leaf);
-    move_data.nodes["leaf_parent"] = delete_leaf(leaf);
+    move_data.nodes = DeletedLeaf{delete_leaf(leaf)};
     move_data.reverse_move_log_kernel =
         node_sampler.get_add_leaf_kernel() +
-        label_sampler.get_sample_label_log_kernel();
+        label_sampler.get_sample_label_log_kernel(move_data.label);
     return move_data;
   }
 
   MoveData add_leaf_move() {
     MoveData move_data;
-    move_data.move_log_kernel = node_sampler.get_add_leaf_kernel() +
-                                label_sampler.get_sample_label_log_kernel();
-    move_data.nodes["added_leaf"] =
-        add_leaf(node_sampler.sample_node(true, random),
-                 label_sampler.sample_label(random));
+    move_data.move_log_kernel = node_sampler.get_add_leaf_kernel();
+    auto leaf = add_leaf(node_sampler.sample_node(true, random),
+                         label_sampler.sample_label(random));
+    move_data.nodes = AddedLeaf{leaf};
+    move_data.move_log_kernel +=
+        label_sampler.get_sample_label_log_kernel(tree.get_node_label(leaf));
     move_data.reverse_move_log_kernel = node_sampler.get_delete_leaf_kernel();
     return move_data;
   }
@@ -130,18 +257,27 @@ private:
   MoveData prune_and_reattach_move() {
     MoveData move_data;
     NodeHandle node_to_prune = node_sampler.sample_node(false, random);
-    move_data.nodes["old_subtree_parent"] = tree.get_parent(node_to_prune);
-    move_data.nodes["prunned_root"] = node_to_prune;
-    prune_and_reattach(node_to_prune, node_sampler.sample_non_descendant(
-                                          node_to_prune, random));
+    move_data.nodes =
+        PrunedSubtree{node_to_prune, tree.get_parent(node_to_prune)};
+    if (attachment == nullptr || breakpoint_support.empty()) {
+      prune_and_reattach(node_to_prune, node_sampler.sample_non_descendant(
+                                            node_to_prune, random));
+      return move_data;
+    }
+    calculate_reattachment_weights(node_to_prune, *attachment);
+    const size_t target = random.categorical(reattachment_weights);
+    move_data.informed = true;
+    move_data.move_log_kernel =
+        get_log_weight_fraction(reattachment_weights, target);
+    move_data.reverse_move_log_kernel = 0.0;
+    prune_and_reattach(node_to_prune, reattachment_targets[target]);
     return move_data;
   }
 
   MoveData swap_labels_move() {
     MoveData move_data;
     auto nodes = node_sampler.sample_nodes_pair(random);
-    move_data.nodes["node1"] = nodes.first;
-    move_data.nodes["node2"] = nodes.second;
+    move_data.nodes = NodesPair{nodes.first, nodes.second};
     swap_labels(nodes.first, nodes.second);
     return move_data;
   }
@@ -150,8 +286,18 @@ private:
     MoveData move_data;
     auto node = node_sampler.sample_node(false, random);
     move_data.label = tree.get_node_label(node);
-    move_data.nodes["node"] = node;
-    change_label(node, label_sampler.sample_label(random));
+    move_data.nodes = ChangedNode{node};
+    auto new_label = label_sampler.sample_label(random);
+    if (informed_labels) {
+      // Uniform kernels are equal in both directions
+      move_data.move_log_kernel =
+          label_sampler.get_sample_label_log_kernel(new_label);
+    }
+    change_label(node, new_label);
+    if (informed_labels) {
+      move_data.reverse_move_log_kernel =
+          label_sampler.get_sample_label_log_kernel(move_data.label);
+    }
     return move_data;
   }
 
@@ -164,9 +310,8 @@ private:
     auto descendant_of_descendant =
         node_sampler.sample_descendant(descendant, random);
     move_data.boolean_flag = false;
-    move_data.nodes["middle_node"] = descendant;
-    move_data.nodes["first_node"] = node;
-    move_data.nodes["parent_of_middle_node"] = tree.get_parent(descendant);
+    move_data.nodes =
+        SwappedDescendants{descendant, node, tree.get_parent(descendant)};
 
     swap_subtrees_descendants(node, descendant, descendant_of_descendant);
     move_data.reverse_move_log_kernel =
@@ -177,8 +322,7 @@ private:
   MoveData swap_subtrees_non_descendants_move(NodeHandle node1,
                                               NodeHandle node2) {
     MoveData move_data;
-    move_data.nodes["node1"] = node1;
-    move_data.nodes["node2"] = node2;
+    move_data.nodes = NodesPair{node1, node2};
     move_data.boolean_flag = true;
     swap_subtrees_non_descendants(node1, node2);
     return move_data;
@@ -198,22 +342,25 @@ private:
   MoveData swap_breakpoints_move() {
     MoveData move_data;
     auto nodes = node_sampler.sample_nodes_pair(random);
-    move_data.nodes["node1"] = nodes.first;
-    move_data.nodes["node2"] = nodes.second;
+    move_data.nodes = NodesPair{nodes.first, nodes.second};
     move_data.label = tree.get_node_label(nodes.first);
-    swap_breakpoints(nodes.first, nodes.second, random.random_int_bit(),
-                     random.random_int_bit());
+    move_data.second_label = tree.get_node_label(nodes.second);
+    move_data.right = random.random_int_bit();
+    move_data.left = random.random_int_bit();
+    swap_breakpoints(nodes.first, nodes.second, move_data.left,
+                     move_data.right);
     return move_data;
   }
 
-  void swap_breakpoints_rollback(MoveData move_data) {
+  void swap_breakpoints_rollback(const MoveData &move_data) {
     int right = 0, left = 0;
-    auto label1 = tree.get_node_label(move_data.nodes["node1"]);
+    auto &nodes = std::get<NodesPair>(move_data.nodes);
+    auto label1 = tree.get_node_label(nodes.node1);
     if (label1.first == move_data.label.first &&
         label1.second == move_data.label.second) {
       return;
     }
-    auto label2 = tree.get_node_label(move_data.nodes["node2"]);
+    auto label2 = tree.get_node_label(nodes.node2);
     if (label1.first == move_data.label.first ||
         label1.first == move_data.label.second) {
       left = 1;
@@ -222,58 +369,104 @@ private:
         label2.second == move_data.label.second) {
       right = 1;
     }
-    swap_breakpoints(move_data.nodes["node1"], move_data.nodes["node2"], left,
-                     right);
-  }
-
-  Real_t get_total_events_length() {
-    auto events = tree.get_all_events();
-    Real_t events_length = 0.0;
-    std::for_each(events.begin(), events.end(),
-                  [&events_length, this](Event e) {
-                    events_length += this->cells.get_event_length(e);
-                  });
-    return events_length;
+    swap_breakpoints(nodes.node1, nodes.node2, left, right);
   }
 
 public:
   MHStepsExecutor<Real_t>(EventTree &t, CONETInputData<Real_t> &cells,
                           Random<Real_t> &r)
-      : tree{t}, label_sampler{cells.get_loci_count() - 1,
-                               cells.get_chromosome_end_markers()},
-        node_sampler{tree}, cells{cells}, random{r} {
+      : tree{t}, label_sampler{cells}, node_sampler{tree}, cells{cells},
+        random{r} {
     for (auto event : tree.get_all_events()) {
       label_sampler.add_label(event);
+      events_length += cells.get_event_length(event);
     }
   }
 
+  /**
+   * Creates executor for @t, which is a copy of the tree of @other. Both
+   * executors sample the same moves as long as their random generators are in
+   * the same state.
+   */
+  MHStepsExecutor<Real_t>(EventTree &t, const MHStepsExecutor<Real_t> &other,
+                          Random<Real_t> &r)
+      : tree{t}, label_sampler{other.label_sampler},
+        node_sampler{t, other.node_sampler}, cells{other.cells}, random{r},
+        informed_labels{other.informed_labels},
+        events_length{other.events_length} {}
+
+  /**
+   * PRUNE_REATTACH moves will prefer reattachment of a subtree below nodes
+   * whose cells support breakpoints of the subtree root. @support[l][c] is
+   * true if cell c supports a breakpoint at locus l. Used only when
+   * attachment is set.
+   */
+  void enable_informed_reattachment(std::vector<std::vector<bool>> support) {
+    breakpoint_support = std::move(support);
+  }
+
+  /**
+   * Sets @at as the attachment of cells to the current tree, nullptr if it
+   * is not known. @at must be kept up to date with the tree.
+   */
+  void set_attachment(const Attachment *at) { attachment = at; }
+
+  /**
+   * Adds to the reverse kernel of an informed move @move_data the part which
+   * depends on attachment @at of cells to the tree after the move.
+   */
+  void complete_reverse_move_log_kernel(MoveData &move_data,
+                                        const Attachment &at) {
+    auto &nodes = std::get<PrunedSubtree>(move_data.nodes);
+    calculate_reattachment_weights(nodes.prunned_root, at);
+    auto old_parent =
+        std::find(reattachment_targets.begin(), reattachment_targets.end(),
+                  nodes.old_subtree_parent);
+    move_data.reverse_move_log_kernel += get_log_weight_fraction(
+        reattachment_weights, old_parent - reattachment_targets.begin());
+  }
+
+  /**
+   * New labels will be sampled with probability proportional to the product
+   * of @locus_weights of their loci.
+   */
+  void enable_informed_label_proposals(std::vector<Real_t> locus_weights) {
+    label_sampler.set_locus_weights(locus_weights, tree.get_all_events());
+    informed_labels = true;
+  }
+
   // reverse move execution
   void rollback_move(MoveType type, MoveData &move_data) {
     switch (type) {
     case ADD_LEAF:
-      delete_leaf(move_data.nodes["added_leaf"]);
+      delete_leaf(std::get<AddedLeaf>(move_data.nodes).added_leaf);
       return;
     case DELETE_LEAF:
-      add_leaf(move_data.nodes["leaf_parent"], move_data.label);
+      add_leaf(std::get<DeletedLeaf>(move_data.nodes).leaf_parent,
+               move_data.label);
       return;
     case CHANGE_LABEL:
-      change_label(move_data.nodes["node"], move_data.label);
+      change_label(std::get<ChangedNode>(move_data.nodes).node,
+                   move_data.label);
       return;
-    case SWAP_LABELS:
-      swap_labels(move_data.nodes["node1"], move_data.nodes["node2"]);
+    case SWAP_LABELS: {
+      auto &nodes = std::get<NodesPair>(move_data.nodes);
+      swap_labels(nodes.node1, nodes.node2);
       return;
-    case PRUNE_REATTACH:
-      prune_and_reattach(move_data.nodes["prunned_root"],
-                         move_data.nodes["old_subtree_parent"]);
+    }
+    case PRUNE_REATTACH: {
+      auto &nodes = std::get<PrunedSubtree>(move_data.nodes);
+      prune_and_reattach(nodes.prunned_root, nodes.old_subtree_parent);
       return;
+    }
     case SWAP_SUBTREES:
       if (move_data.boolean_flag) {
-        swap_subtrees_non_descendants(move_data.nodes["node1"],
-                                      move_data.nodes["node2"]);
+        auto &nodes = std::get<NodesPair>(move_data.nodes);
+        swap_subtrees_non_descendants(nodes.node1, nodes.node2);
       } else {
-        swap_subtrees_descendants(move_data.nodes["middle_node"],
-                                  move_data.nodes["first_node"],
-                                  move_data.nodes["parent_of_middle_node"]);
+        auto &nodes = std::get<SwappedDescendants>(move_data.nodes);
+        swap_subtrees_descendants(nodes.middle_node, nodes.first_node,
+                                  nodes.parent_of_middle_node);
       }
       return;
     case SWAP_ONE_BREAKPOINT:
@@ -302,6 +495,144 @@ public:
     }
   }
 
+  /**
+   * Describes move executed by <code>execute_move(type)</code>. Has to be
+   * called before the move is rolled back.
+   */
+  MoveReplay describe_move(MoveType type, MoveData &move_data) {
+    MoveReplay replay;
+    replay.type = type;
+    switch (type) {
+    case ADD_LEAF: {
+      auto leaf = std::get<AddedLeaf>(move_data.nodes).added_leaf;
+      replay.labels = {tree.get_node_label(tree.get_parent(leaf)),
+                       tree.get_node_label(leaf)};
+      break;
+    }
+    case DELETE_LEAF:
+      replay.labels = {move_data.label};
+      break;
+    case CHANGE_LABEL:
+      replay.labels = {
+          move_data.label,
+          tree.get_node_label(std::get<ChangedNode>(move_data.nodes).node)};
+      break;
+    case SWAP_LABELS: {
+      auto &nodes = std::get<NodesPair>(move_data.nodes);
+      replay.labels = {tree.get_node_label(nodes.node2),
+                       tree.get_node_label(nodes.node1)};
+      break;
+    }
+    case PRUNE_REATTACH: {
+      auto prunned_root = std::get<PrunedSubtree>(move_data.nodes).prunned_root;
+      replay.labels = {tree.get_node_label(prunned_root),
+                       tree.get_node_label(tree.get_parent(prunned_root))};
+      break;
+    }
+    case SWAP_SUBTREES:
+      replay.boolean_flag = move_data.boolean_flag;
+      if (move_data.boolean_flag) {
+        auto &nodes = std::get<NodesPair>(move_data.nodes);
+        replay.labels = {tree.get_node_label(nodes.node1),
+                         tree.get_node_label(nodes.node2)};
+      } else {
+        auto &nodes = std::get<SwappedDescendants>(move_data.nodes);
+        auto first_node = nodes.first_node;
+        replay.labels = {tree.get_node_label(first_node),
+                         tree.get_node_label(nodes.middle_node),
+                         tree.get_node_label(tree.get_parent(first_node))};
+      }
+      break;
+    case SWAP_ONE_BREAKPOINT:
+      replay.labels = {move_data.label, move_data.second_label};
+      replay.left = move_data.left;
+      replay.right = move_data.right;
+      break;
+    }
+    return replay;
+  }
+
+  /**
+   * Executes move described by @replay. Returned data allows for rollback of
+   * the move, move kernels are not calculated.
+   */
+  MoveData replay_move(const MoveReplay &replay) {
+    MoveData move_data;
+    std::vector<NodeHandle> nodes;
+    for (auto label : replay.labels) {
+      nodes.push_back(tree.find_node(label));
+    }
+    switch (replay.type) {
+    case ADD_LEAF:
+      move_data.nodes = AddedLeaf{add_leaf(nodes[0], replay.labels[1])};
+      break;
+    case DELETE_LEAF:
+      move_data.label = replay.labels[0];
+      move_data.nodes = DeletedLeaf{delete_leaf(nodes[0])};
+      break;
+    case CHANGE_LABEL:
+      move_data.label = replay.labels[0];
+      move_data.nodes = ChangedNode{nodes[0]};
+      change_label(nodes[0], replay.labels[1]);
+      break;
+    case SWAP_LABELS:
+      move_data.nodes = NodesPair{nodes[0], nodes[1]};
+      swap_labels(nodes[0], nodes[1]);
+      break;
+    case PRUNE_REATTACH:
+      move_data.nodes = PrunedSubtree{nodes[0], tree.get_parent(nodes[0])};
+      prune_and_reattach(nodes[0], nodes[1]);
+      break;
+    case SWAP_SUBTREES:
+      move_data.boolean_flag = replay.boolean_flag;
+      if (replay.boolean_flag) {
+        move_data.nodes = NodesPair{nodes[0], nodes[1]};
+        swap_subtrees_non_descendants(nodes[0], nodes[1]);
+      } else {
+        move_data.nodes =
+            SwappedDescendants{nodes[1], nodes[0], tree.get_parent(nodes[1])};
+        swap_subtrees_descendants(nodes[0], nodes[1], nodes[2]);
+      }
+      break;
+    case SWAP_ONE_BREAKPOINT:
+      move_data.nodes = NodesPair{nodes[0], nodes[1]};
+      move_data.label = replay.labels[0];
+      move_data.second_label = replay.labels[1];
+      move_data.left = replay.left;
+      move_data.right = replay.right;
+      swap_breakpoints(nodes[0], nodes[1], replay.left, replay.right);
+      break;
+    }
+    return move_data;
+  }
+
+  /**
+   * Returns labels of nodes referenced by @move_data.
+   */
+  MoveLabels get_node_labels(MoveData &move_data) {
+    MoveLabels labels;
+    auto get_label = [this, &labels](NodeHandle &node) {
+      labels.labels[labels.size++] = tree.get_node_label(node);
+    };
+    std::visit([&get_label](auto &nodes) { nodes.for_each(get_label); },
+               move_data.nodes);
+    return labels;
+  }
+
+  /**
+   * Points node handles of @move_data to nodes with labels @labels. Moves
+   * executed and rolled back after @move_data has been created may delete and
+   * recreate its nodes, which invalidates the handles.
+   */
+  void refresh_node_handles(MoveData &move_data, const MoveLabels &labels) {
+    size_t i = 0;
+    auto find_node = [this, &labels, &i](NodeHandle &node) {
+      node = tree.find_node(labels.labels[i++]);
+    };
+    std::visit([&find_node](auto &nodes) { nodes.for_each(find_node); },
+               move_data.nodes);
+  }
+
   bool move_is_possible(MoveType type) {
     switch (type) {
     case ADD_LEAF:
@@ -319,12 +650,15 @@ public:
     }
   }
 
+  /**
+   * All terms of the prior are maintained by moves, so it takes O(1) time.
+   */
   Real_t get_log_tree_prior() {
     const Real_t C = std::log((Real_t)tree.get_size()) -
                      label_sampler.get_sample_label_log_kernel() +
                      node_sampler.get_delete_leaf_kernel();
     return -C * (Real_t)tree.get_size() -
-           EVENTS_LENGTH_PENALTY * get_total_events_length() -
+           EVENTS_LENGTH_PENALTY * events_length -
            DATA_SIZE_PRIOR_CONSTANT * ((Real_t)cells.get_cells_count()) *
                tree.get_size();
   }
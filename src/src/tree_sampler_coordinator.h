@@ -1,15 +1,20 @@
 #ifndef TREE_SAMPLER_COORDINATOR_H
 #define TREE_SAMPLER_COORDINATOR_H
 #include <algorithm>
+#include <map>
+#include <memory>
 #include <tuple>
 #include <vector>
 
 #include "conet_result.h"
+#include "moves/move_type_scheduler.h"
+#include "multiple_try_worker.h"
 #include "tree/attachment.h"
 #include "tree/tree_counts_scoring.h"
 #include "tree/tree_formatter.h"
 #include "tree_mh_steps_executor.h"
 #include "utils/logger/logger.h"
+#include "utils/thread_pool.h"
 #include "utils/utils.h"
 /**
  * Class coordinating all components of MH sampling.
@@ -26,87 +31,449 @@
 template <class Real_t> class TreeSamplerCoordinator {
   using NodeHandle = EventTree::NodeHandle;
   using MoveData = typename MHStepsExecutor<Real_t>::MoveData;
+  using MoveReplay = typename MHStepsExecutor<Real_t>::MoveReplay;
+  using Proposal = typename MultipleTryWorker<Real_t>::Proposal;
   EventTree &tree;
   LikelihoodCoordinator<Real_t> &likelihood_coordinator;
   CountsDispersionPenalty<Real_t> dispersion_penalty_calculator;
   Random<Real_t> random;
-  std::map<MoveType, Real_t> move_probabilities;
+  MoveTypeScheduler<Real_t> move_scheduler;
   Real_t temperature{1.0};
-  Real_t tree_count_dispersion_penalty{1.0}; // penalty value of a current tree
+  // Penalty value of the current tree, updated by accepted moves and
+  // recalculated only when the attachment changes otherwise
+  Real_t tree_count_dispersion_penalty{1.0};
+  // Change of the log target by the last accepted move
+  Real_t last_log_target_change{0.0};
   Utils::MaxValueAccumulator<CONETInferenceResult<Real_t>, Real_t>
       best_found_tree;
   MHStepsExecutor<Real_t> mh_step_executor;
+  CONETInputData<Real_t> &cells;
 
-  Real_t get_probability_of_reverse_move(MoveType type) {
+  // Workers used by multiple-try Metropolis or speculative steps
+  std::vector<std::unique_ptr<MultipleTryWorker<Real_t>>> workers;
+  std::unique_ptr<ThreadPool> workers_pool;
+  bool multiple_try{false};
+  std::vector<Proposal> proposals;
+  std::vector<Proposal> reference_proposals;
+
+  struct Speculation {
+    Proposal proposal;
+    Real_t log_uniform{0.0};
+  };
+  bool speculative{false};
+  std::vector<Speculation> speculations;
+
+  // Delayed acceptance is used if surrogate likelihood is set
+  std::unique_ptr<CONETInputData<Real_t>> surrogate_cells;
+  std::unique_ptr<LikelihoodCoordinator<Real_t>> surrogate_likelihood;
+  Real_t surrogate_scale{1.0};
+
+  // Replicas may target tempered likelihood of a cells subsample instead of
+  // all cells. State of the fidelity which is not targeted is outdated after
+  // accepted moves and is recalculated on demand.
+  std::unique_ptr<LikelihoodCoordinator<Real_t>> approximate_likelihood;
+  std::unique_ptr<CountsDispersionPenalty<Real_t>> approximate_penalty;
+  Real_t approximate_scale{1.0};
+  bool approximate{false};
+  bool exact_state_outdated{false};
+  bool approximate_state_outdated{false};
+  bool informed_reattachment{false};
+  // Locus weights of informed label proposals, empty if they are not used
+  std::vector<Real_t> informed_label_weights;
+  // Speculative scores may differ from scores calculated by the ordinary
+  // step by rounding errors. Moves with log acceptance ratio within this
+  // relative distance from the threshold are always evaluated exactly.
+  static constexpr Real_t SPECULATION_TOLERANCE = 1e-6;
+
+  Real_t get_probability_of_reverse_move(MoveType type) const {
     switch (type) {
     case ADD_LEAF:
-      return move_probabilities[DELETE_LEAF];
+      return move_scheduler.get_weight(DELETE_LEAF);
     case DELETE_LEAF:
-      return move_probabilities[ADD_LEAF];
+      return move_scheduler.get_weight(ADD_LEAF);
     case CHANGE_LABEL:
-      return move_probabilities[CHANGE_LABEL];
+      return move_scheduler.get_weight(CHANGE_LABEL);
     case SWAP_LABELS:
-      return move_probabilities[SWAP_LABELS];
+      return move_scheduler.get_weight(SWAP_LABELS);
     case PRUNE_REATTACH:
-      return move_probabilities[PRUNE_REATTACH];
+      return move_scheduler.get_weight(PRUNE_REATTACH);
     case SWAP_SUBTREES:
-      return move_probabilities[SWAP_SUBTREES];
+      return move_scheduler.get_weight(SWAP_SUBTREES);
     case SWAP_ONE_BREAKPOINT:
     default:
-      return move_probabilities[SWAP_ONE_BREAKPOINT];
+      return move_scheduler.get_weight(SWAP_ONE_BREAKPOINT);
     }
   }
 
-  void move(MoveType type) {
-    recalculate_counts_dispersion_penalty();
+  LikelihoodCoordinator<Real_t> &get_likelihood_coordinator(bool approximate) {
+    return approximate ? *approximate_likelihood : likelihood_coordinator;
+  }
+
+  CountsDispersionPenalty<Real_t> &get_penalty_calculator(bool approximate) {
+    return approximate ? *approximate_penalty : dispersion_penalty_calculator;
+  }
+
+  Real_t get_likelihood_scale(bool approximate) const {
+    return approximate ? approximate_scale : 1.0;
+  }
+
+  /**
+   * Brings likelihood state of fidelity @approximate up to date with the
+   * tree.
+   */
+  void synchronize_likelihood(bool approximate) {
+    bool &outdated =
+        approximate ? approximate_state_outdated : exact_state_outdated;
+    if (outdated) {
+      get_likelihood_coordinator(approximate).recalculate_likelihood();
+      outdated = false;
+    }
+  }
+
+  // Move type term of the log acceptance ratio, the same as in @move
+  Real_t get_log_move_type_ratio(MoveType type) const {
+    return std::log(move_scheduler.get_weight(type)) -
+           std::log(get_probability_of_reverse_move(type));
+  }
+
+  /**
+   * Executes MH step with move of type @type. Returns true if the move has
+   * been accepted.
+   */
+  bool move(MoveType type) {
     auto before_move_likelihood =
-        temperature * likelihood_coordinator.get_likelihood() +
+        temperature * get_likelihood_scale(approximate) *
+            get_likelihood_coordinator(approximate).get_likelihood() +
         mh_step_executor.get_log_tree_prior() + tree_count_dispersion_penalty;
+    const bool delayed_acceptance = surrogate_likelihood && !approximate;
+    // Informed kernels need attachment of all cells to the current tree and
+    // to the proposed one. Speculative steps don't use them, so neither do
+    // single steps of a speculative sampler, which must follow the same chain.
+    const bool informed = informed_reattachment && !approximate &&
+                          !delayed_acceptance && !speculative;
+    mh_step_executor.set_attachment(
+        informed ? &likelihood_coordinator.get_max_attachment() : nullptr);
+    const Real_t before_move_surrogate =
+        delayed_acceptance ? get_surrogate_log_target(
+                                 surrogate_likelihood->get_likelihood())
+                           : 0.0;
 
     auto move_data = mh_step_executor.execute_move(type);
+    if (speculative) {
+      // Workers of speculative steps have to follow accepted moves
+      const auto replay = mh_step_executor.describe_move(type, move_data);
+      const bool accepted =
+          accept_or_reject(type, move_data, before_move_likelihood);
+      if (accepted) {
+        commit_to_workers(replay);
+      }
+      return accepted;
+    }
+    if (!delayed_acceptance) {
+      return accept_or_reject(type, move_data, before_move_likelihood);
+    }
+
+    // Delayed acceptance (Christen, Fox 2005). The second stage ratio is the
+    // full ratio divided by the first stage ratio, so the chain still targets
+    // the exact posterior.
+    Real_t first_stage_log_acceptance =
+        get_surrogate_log_target(surrogate_likelihood->calculate_likelihood()) -
+        before_move_surrogate + move_data.reverse_move_log_kernel -
+        move_data.move_log_kernel + get_log_move_type_ratio(type);
+    if (random.log_uniform() > first_stage_log_acceptance) {
+      mh_step_executor.rollback_move(type, move_data);
+      log_debug("Move rejected in the first stage");
+      return false;
+    }
+    if (accept_or_reject(type, move_data, before_move_likelihood,
+                         first_stage_log_acceptance)) {
+      surrogate_likelihood->persist_likelihood_calculation_result();
+      return true;
+    }
+    return false;
+  }
 
+  /**
+   * Target of the first stage of delayed acceptance: tempered likelihood of
+   * the cells subsample, scaled to all cells, plus tree prior.
+   */
+  Real_t get_surrogate_log_target(Real_t subsample_likelihood) {
+    return temperature * surrogate_scale * subsample_likelihood +
+           mh_step_executor.get_log_tree_prior();
+  }
+
+  /**
+   * Calculates acceptance ratio of move @type which has been executed on the
+   * tree and either persists it or rolls it back. Returns true if the move
+   * has been accepted.
+   *
+   * @param first_stage_log_acceptance - log acceptance ratio of the first
+   * stage of delayed acceptance, if the move has passed it
+   */
+  bool accept_or_reject(MoveType type, MoveData &move_data,
+                        Real_t before_move_likelihood,
+                        Real_t first_stage_log_acceptance = 0.0) {
+    // Threshold is drawn first, so that the move may be rejected before its
+    // counts dispersion penalty is calculated
+    const Real_t log_uniform = random.log_uniform();
+    auto &target_likelihood = get_likelihood_coordinator(approximate);
+    auto &penalty_calculator = get_penalty_calculator(approximate);
     auto after_move_likelihood =
-        temperature * likelihood_coordinator.calculate_likelihood() +
+        temperature * get_likelihood_scale(approximate) *
+            target_likelihood.calculate_likelihood() +
         mh_step_executor.get_log_tree_prior();
+    if (move_data.informed) {
+      mh_step_executor.complete_reverse_move_log_kernel(
+          move_data, target_likelihood.calculate_max_attachment());
+    }
+
+    const Real_t log_proposal_ratio =
+        move_data.reverse_move_log_kernel - move_data.move_log_kernel +
+        std::log(move_scheduler.get_weight(type)) -
+        std::log(get_probability_of_reverse_move(type));
+
+    if (after_move_likelihood + penalty_calculator.get_log_score_upper_bound() -
+            before_move_likelihood + log_proposal_ratio -
+            first_stage_log_acceptance <
+        log_uniform) {
+      mh_step_executor.rollback_move(type, move_data);
+      log_debug("Move rejected before counts dispersion penalty calculation");
+      return false;
+    }
+
     auto after_move_counts_dispersion_penalty =
-        dispersion_penalty_calculator.calculate_log_score(
-            tree, likelihood_coordinator.calculate_max_attachment());
+        penalty_calculator.calculate_log_score(
+            tree, target_likelihood.calculate_max_attachment());
     after_move_likelihood += after_move_counts_dispersion_penalty;
 
     Real_t log_acceptance = after_move_likelihood - before_move_likelihood +
                             move_data.reverse_move_log_kernel -
                             move_data.move_log_kernel +
-                            std::log(move_probabilities[type]) -
+                            std::log(move_scheduler.get_weight(type)) -
                             std::log(get_probability_of_reverse_move(type));
+    log_acceptance -= first_stage_log_acceptance;
 
     log_debug("Log acceptance ratio: ", log_acceptance, " likelihood before ",
               before_move_likelihood, " likelihood after ",
               after_move_likelihood);
 
+    if (log_uniform <= log_acceptance) {
+      target_likelihood.persist_likelihood_calculation_result();
+      tree_count_dispersion_penalty = after_move_counts_dispersion_penalty;
+      last_log_target_change = after_move_likelihood - before_move_likelihood;
+      if (approximate_likelihood) {
+        (approximate ? exact_state_outdated : approximate_state_outdated) =
+            true;
+      }
+      log_debug("Move accepted");
+      return true;
+    }
+    mh_step_executor.rollback_move(type, move_data);
+    log_debug("Move rejected");
+    return false;
+  }
+
+  /**
+   * Executes at most @steps MH steps, assuming that all of them will be
+   * rejected. Returns number of executed steps.
+   *
+   * Moves of consecutive steps are sampled up front on a copy of the sampler
+   * state and workers score them in parallel against the current tree. Then
+   * the steps are executed in order: a move which is clearly rejected
+   * according to its speculative score is rolled back without likelihood
+   * calculation, otherwise the step is evaluated as the ordinary MH step. The
+   * first accepted move invalidates the remaining speculations. Random numbers
+   * are drawn exactly as in the ordinary steps, so the chain is the same as
+   * the sequential one.
+   */
+  size_t speculative_steps(size_t steps) {
+    steps = std::min(steps, workers.size());
+    EventTree speculation_tree = tree;
+    Random<Real_t> speculation_random = random;
+    MHStepsExecutor<Real_t> speculation_executor{
+        speculation_tree, mh_step_executor, speculation_random};
+    for (size_t s = 0; s < steps; s++) {
+      auto &speculation = speculations[s];
+      auto type = sample_move_type(speculation_random);
+      speculation.proposal.is_move =
+          speculation_executor.move_is_possible(type);
+      if (!speculation.proposal.is_move) {
+        continue;
+      }
+      auto move_data = speculation_executor.execute_move(type);
+      speculation.proposal.move =
+          speculation_executor.describe_move(type, move_data);
+      speculation.proposal.log_proposal_ratio =
+          move_data.reverse_move_log_kernel - move_data.move_log_kernel +
+          get_log_move_type_ratio(type);
+      speculation_executor.rollback_move(type, move_data);
+      speculation.log_uniform = speculation_random.log_uniform();
+    }
+
+    workers_pool->run(steps, [this](size_t s) {
+      auto &proposal = speculations[s].proposal;
+      if (proposal.is_move) {
+        auto log_proposal_ratio = proposal.log_proposal_ratio;
+        proposal = workers[s]->score(proposal.move, temperature);
+        proposal.log_proposal_ratio = log_proposal_ratio;
+      }
+    });
+
+    const Real_t before_move_likelihood =
+        temperature * likelihood_coordinator.get_likelihood() +
+        mh_step_executor.get_log_tree_prior() + tree_count_dispersion_penalty;
+    for (size_t s = 0; s < steps; s++) {
+      MoveType type = sample_move_type(random);
+      if (mh_step_executor.move_is_possible(type)) {
+        auto &speculation = speculations[s];
+        auto move_data = mh_step_executor.execute_move(type);
+        const Real_t speculative_log_acceptance =
+            speculation.proposal.log_target - before_move_likelihood +
+            speculation.proposal.log_proposal_ratio;
+        const Real_t margin =
+            SPECULATION_TOLERANCE * (std::abs(before_move_likelihood) + 1.0);
+        if (speculative_log_acceptance + margin < speculation.log_uniform) {
+          random.log_uniform();
+          mh_step_executor.rollback_move(type, move_data);
+        } else if (accept_or_reject(type, move_data, before_move_likelihood)) {
+          commit_to_workers(speculation.proposal.move);
+          update_best_found_tree();
+          return s + 1;
+        }
+      }
+      update_best_found_tree();
+    }
+    return steps;
+  }
+
+  /**
+   * Multiple-try Metropolis step (Liu, Liang, Wong 2000).
+   *
+   * Each worker proposes a move from the current tree x. Proposal y_j gets
+   * weight <code>w(y_j) = pi(y_j) * sqrt(q(y_j -> x) / q(x -> y_j))</code>
+   * and one of them, y, is selected with probability proportional to its
+   * weight. Then all but one worker propose reference moves from y, the last
+   * reference point is x itself. Selected move is accepted with probability
+   * <code>min(1, sum w(y_j) / sum w(x_j))</code>, where weights of reference
+   * points are calculated relative to y. For a single try this reduces to
+   * the ordinary MH step.
+   */
+  void multiple_try_step() {
+    const Real_t current_log_target =
+        temperature * likelihood_coordinator.get_likelihood() +
+        mh_step_executor.get_log_tree_prior() + tree_count_dispersion_penalty;
+    const size_t tries = workers.size();
+
+    workers_pool->run(tries, [this](size_t w) {
+      auto &worker = *workers[w];
+      auto type = sample_move_type(worker.get_random());
+      proposals[w] = worker.propose(type, get_log_move_type_ratio(type),
+                                    temperature);
+    });
+    std::vector<Real_t> log_weights;
+    for (auto &proposal : proposals) {
+      log_weights.push_back(proposal.is_move ? proposal.log_target +
+                                                   proposal.log_proposal_ratio / 2
+                                             : current_log_target);
+    }
+    auto &selected = proposals[sample_log_weights(log_weights)];
+    if (!selected.is_move) {
+      return;
+    }
+
+    workers_pool->run(tries - 1, [this, &selected](size_t w) {
+      auto &worker = *workers[w];
+      worker.replay(selected.move);
+      auto type = sample_move_type(worker.get_random());
+      reference_proposals[w] = worker.propose(
+          type, get_log_move_type_ratio(type), temperature);
+    });
+    std::vector<Real_t> reference_log_weights;
+    for (size_t w = 0; w + 1 < tries; w++) {
+      auto &proposal = reference_proposals[w];
+      reference_log_weights.push_back(
+          proposal.is_move
+              ? proposal.log_target + proposal.log_proposal_ratio / 2
+              : selected.log_target);
+    }
+    reference_log_weights.push_back(current_log_target -
+                                    selected.log_proposal_ratio / 2);
+
+    Real_t log_acceptance =
+        log_sum_exp(log_weights) - log_sum_exp(reference_log_weights);
+    log_debug("Multiple-try log acceptance ratio: ", log_acceptance);
+
     if (random.log_uniform() <= log_acceptance) {
+      mh_step_executor.replay_move(selected.move);
+      likelihood_coordinator.calculate_likelihood();
       likelihood_coordinator.persist_likelihood_calculation_result();
-      tree_count_dispersion_penalty = after_move_counts_dispersion_penalty;
+      tree_count_dispersion_penalty = selected.counts_dispersion_penalty;
+      commit_to_workers(selected.move);
       log_debug("Move accepted");
     } else {
-      mh_step_executor.rollback_move(type, move_data);
+      workers_pool->run(tries - 1,
+                        [this](size_t w) { workers[w]->rollback_replay(); });
       log_debug("Move rejected");
     }
   }
 
-  MoveType sample_move_type() {
-    std::map<size_t, MoveType> type_to_index;
+  static Real_t log_sum_exp(const std::vector<Real_t> &log_weights) {
+    const Real_t max =
+        *std::max_element(log_weights.begin(), log_weights.end());
+    Real_t sum = 0.0;
+    for (auto w : log_weights) {
+      sum += std::exp(w - max);
+    }
+    return max + std::log(sum);
+  }
+
+  void commit_to_workers(const MoveReplay &move) {
+    workers_pool->run(workers.size(),
+                      [this, &move](size_t w) { workers[w]->commit(move); });
+  }
+
+  void create_workers(size_t count, Random<Real_t> &seeds) {
+    workers.clear();
+    for (size_t i = 0; i < count; i++) {
+      workers.push_back(std::make_unique<MultipleTryWorker<Real_t>>(
+          tree, likelihood_coordinator.get_likelihood_matrices(), cells,
+          seeds.next_int()));
+    }
+    workers_pool = std::make_unique<ThreadPool>(count);
+  }
+
+  /**
+   * Trees are copied only when they improve the best likelihood, which is
+   * rare compared to the number of MH steps.
+   */
+  void update_best_found_tree() {
+    auto l = get_total_likelihood();
+    auto &attachment = likelihood_coordinator.get_max_attachment();
+    best_found_tree.update_lazily(
+        l, [&]() { return CONETInferenceResult<Real_t>(tree, attachment, l); },
+        [&](CONETInferenceResult<Real_t> &best) {
+          best.assign(tree, attachment, l);
+        });
+  }
+
+  size_t sample_log_weights(const std::vector<Real_t> &log_weights) {
+    const Real_t max =
+        *std::max_element(log_weights.begin(), log_weights.end());
     std::vector<Real_t> weights;
-    for (auto x : move_probabilities) {
-      type_to_index[weights.size()] = x.first;
-      weights.push_back(x.second);
+    for (auto w : log_weights) {
+      weights.push_back(std::exp(w - max));
     }
-    return type_to_index[random.discrete(weights)];
+    return random.discrete(weights);
+  }
+
+  MoveType sample_move_type(Random<Real_t> &random) const {
+    return move_scheduler.sample(random);
   }
 
   void recalculate_counts_dispersion_penalty() {
     tree_count_dispersion_penalty =
-        dispersion_penalty_calculator.calculate_log_score(
-            tree, likelihood_coordinator.get_max_attachment());
+        get_penalty_calculator(approximate).calculate_log_score(
+            tree, get_likelihood_coordinator(approximate).get_max_attachment());
   }
 
 public:
@@ -115,11 +482,193 @@ public:
                          std::map<MoveType, Real_t> move_probabilities)
       : tree{tree}, likelihood_coordinator{lC},
         dispersion_penalty_calculator{cells}, random{seed},
-        move_probabilities{move_probabilities}, mh_step_executor{tree, cells,
-                                                                 random} {}
+        move_scheduler{move_probabilities},
+        mh_step_executor{tree, cells, random}, cells{cells} {
+    recalculate_counts_dispersion_penalty();
+  }
+
+  /**
+   * Executes Gibbs step for likelihood parameters. Accepted parameters change
+   * the attachment, so the counts dispersion penalty is recalculated.
+   */
+  void resample_likelihood_parameters() {
+    likelihood_coordinator.resample_likelihood_parameters(
+        get_log_tree_prior(), tree_count_dispersion_penalty);
+    recalculate_counts_dispersion_penalty();
+  }
+
+  /**
+   * Switches sampling to multiple-try Metropolis with @tries proposals per
+   * step, which are evaluated in parallel. Informed proposals enabled before
+   * are used by all tries. Likelihood parameters must not change afterwards.
+   */
+  void enable_multiple_try(size_t tries) {
+    if (tries < 2) {
+      return;
+    }
+    create_workers(tries, random);
+    const auto support = informed_reattachment
+                             ? likelihood_coordinator.get_breakpoint_support()
+                             : std::vector<std::vector<bool>>{};
+    for (auto &worker : workers) {
+      if (!informed_label_weights.empty()) {
+        worker->enable_informed_label_proposals(informed_label_weights);
+      }
+      if (informed_reattachment) {
+        worker->enable_informed_reattachment(support);
+      }
+    }
+    multiple_try = true;
+    speculative = false;
+    proposals.resize(tries);
+    reference_proposals.resize(tries);
+  }
+
+  /**
+   * Enables speculative execution of up to @steps consecutive MH steps in
+   * parallel by <code>execute_metropolis_hastings_steps</code>. The chain is
+   * the same as without speculation. Likelihood parameters must not change
+   * afterwards.
+   */
+  void enable_speculative_steps(size_t steps) {
+    if (steps < 2) {
+      return;
+    }
+    // Worker generators are not used by speculative steps, seeds are not
+    // drawn from the sampler generator so that the chain is not affected.
+    Random<Real_t> seeds{0};
+    create_workers(steps, seeds);
+    speculative = true;
+    multiple_try = false;
+    speculations.resize(steps);
+  }
+
+  /**
+   * Makes ADD_LEAF and CHANGE_LABEL moves propose labels whose loci have high
+   * breakpoint evidence in the data more often. Weight of a locus is its
+   * evidence plus the mean evidence, so that every label keeps a positive
+   * probability. Likelihood parameters must not change afterwards and
+   * multiple-try Metropolis must not be enabled yet.
+   */
+  void enable_informed_label_proposals() {
+    auto weights = likelihood_coordinator.get_breakpoint_evidence();
+    Real_t mean_evidence = 0.0;
+    for (auto w : weights) {
+      mean_evidence += w / weights.size();
+    }
+    for (auto &w : weights) {
+      w = mean_evidence > 0.0 ? w + mean_evidence : 1.0;
+    }
+    mh_step_executor.enable_informed_label_proposals(weights);
+    informed_label_weights = std::move(weights);
+  }
+
+  /**
+   * Makes PRUNE_REATTACH moves in ordinary and multiple-try MH steps prefer
+   * reattachment of a subtree below nodes whose cells support its root
+   * breakpoints. Not used with delayed acceptance or approximate likelihood,
+   * which do not know the attachment of all cells, nor with speculative
+   * steps. Likelihood parameters must not change afterwards and multiple-try
+   * Metropolis must not be enabled yet.
+   */
+  void enable_informed_reattachment() {
+    mh_step_executor.enable_informed_reattachment(
+        likelihood_coordinator.get_breakpoint_support());
+    informed_reattachment = true;
+  }
+
+  /**
+   * Move type weights will be adapted during the next @steps ordinary MH
+   * steps and frozen afterwards. Not available with multiple-try Metropolis
+   * or speculative steps, whose proposals are sampled ahead.
+   */
+  void enable_move_type_adaptation(size_t steps) {
+    if (!multiple_try && !speculative) {
+      move_scheduler.enable_adaptation(steps);
+    }
+  }
+
+  /**
+   * Enables delayed acceptance in ordinary MH steps. Moves are first
+   * accepted or rejected based on likelihood of @cells_count randomly chosen
+   * cells and only moves which pass are scored on all cells. Likelihood
+   * parameters must not change afterwards.
+   *
+   * @param threads - number of threads of the subsample likelihood
+   * calculation
+   */
+  void enable_delayed_acceptance(size_t cells_count, size_t threads) {
+    const size_t all_cells_count = cells.get_cells_count();
+    if (cells_count == 0 || cells_count >= all_cells_count) {
+      return;
+    }
+    auto subsample = random.subset(all_cells_count, cells_count);
+    surrogate_cells = std::make_unique<CONETInputData<Real_t>>(
+        cells.get_cells_subset(subsample));
+    surrogate_likelihood = std::make_unique<LikelihoodCoordinator<Real_t>>(
+        likelihood_coordinator.get_likelihood_data(), tree, *surrogate_cells,
+        random.next_int(), threads);
+    surrogate_scale = (Real_t)all_cells_count / cells_count;
+  }
+
+  /**
+   * Enables switching of the sampler to the approximate likelihood, which is
+   * the likelihood of cells @cells_subset scaled to all cells. Likelihood
+   * parameters must not change afterwards.
+   *
+   * @param threads - number of threads of the subsample likelihood
+   * calculation
+   */
+  void enable_approximate_likelihood(CONETInputData<Real_t> &cells_subset,
+                                     size_t threads) {
+    approximate_likelihood = std::make_unique<LikelihoodCoordinator<Real_t>>(
+        likelihood_coordinator.get_likelihood_data(), tree, cells_subset,
+        random.next_int(), threads);
+    approximate_penalty =
+        std::make_unique<CountsDispersionPenalty<Real_t>>(cells_subset);
+    approximate_scale =
+        (Real_t)cells.get_cells_count() / cells_subset.get_cells_count();
+    // Replica may never target the exact likelihood, so its current tree
+    // is the first candidate for the inferred tree
+    recalculate_counts_dispersion_penalty();
+    update_best_found_tree();
+  }
+
+  /**
+   * Switches the sampler target between the exact and the approximate
+   * likelihood. Only the exact likelihood contributes to the inferred tree.
+   */
+  void set_approximate(bool approximate) {
+    if (!approximate_likelihood || this->approximate == approximate) {
+      return;
+    }
+    this->approximate = approximate;
+    synchronize_likelihood(approximate);
+    recalculate_counts_dispersion_penalty();
+    if (!approximate) {
+      update_best_found_tree();
+    }
+  }
+
+  bool is_approximate() const { return approximate; }
+
+  /**
+   * Returns tempered likelihood plus counts dispersion penalty of the current
+   * tree with likelihood of fidelity @approximate.
+   */
+  Real_t get_tempered_likelihood_with_penalty(Real_t temperature,
+                                              bool approximate) {
+    synchronize_likelihood(approximate);
+    auto &coordinator = get_likelihood_coordinator(approximate);
+    return temperature * get_likelihood_scale(approximate) *
+               coordinator.get_likelihood() +
+           get_penalty_calculator(approximate).calculate_log_score(
+               tree, coordinator.get_max_attachment());
+  }
 
   Real_t get_likelihood_without_priors_and_penalty() {
-    return likelihood_coordinator.get_likelihood();
+    return get_likelihood_scale(approximate) *
+           get_likelihood_coordinator(approximate).get_likelihood();
   }
 
   void set_temperature(Real_t temperature) { this->temperature = temperature; }
@@ -139,19 +688,42 @@ public:
     return tree_count_dispersion_penalty;
   }
 
+  /**
+   * Executes one MH step. A single step gains nothing from speculation, so
+   * it is executed as the ordinary step, which yields the same chain.
+   */
   void execute_metropolis_hastings_step() {
-    MoveType type = sample_move_type();
-    log_debug("Sampled move of type: ", move_type_to_string(type));
+    if (multiple_try) {
+      multiple_try_step();
+    } else {
+      MoveType type = sample_move_type(random);
+      log_debug("Sampled move of type: ", move_type_to_string(type));
 
-    if (mh_step_executor.move_is_possible(type)) {
-      move(type);
+      if (mh_step_executor.move_is_possible(type)) {
+        auto &target_likelihood = get_likelihood_coordinator(approximate);
+        const size_t calculated_records =
+            target_likelihood.get_calculated_records_count();
+        const bool accepted = move(type);
+        move_scheduler.record(
+            type, accepted ? last_log_target_change : 0.0,
+            target_likelihood.get_calculated_records_count() -
+                calculated_records);
+      }
+    }
+    if (!approximate) {
+      update_best_found_tree();
     }
+  }
 
-    auto l = get_total_likelihood();
-    best_found_tree.update(
-        CONETInferenceResult<Real_t>(
-            tree, likelihood_coordinator.get_max_attachment(), l),
-        l);
+  void execute_metropolis_hastings_steps(size_t steps) {
+    while (steps > 0) {
+      if (speculative && steps > 1) {
+        steps -= speculative_steps(steps);
+      } else {
+        execute_metropolis_hastings_step();
+        steps--;
+      }
+    }
   }
 
   CONETInferenceResult<Real_t> get_inferred_tree() {
@@ -0,0 +1,59 @@
+#ifndef ALIAS_TABLE_H
+#define ALIAS_TABLE_H
+#include <vector>
+
+#include "random.h"
+
+/**
+ * Walker's alias table for sampling from a fixed discrete distribution in
+ * constant time.
+ */
+template <class Real_t> class AliasTable {
+  // Probability of keeping the sampled column, its alias is chosen otherwise
+  std::vector<Real_t> probability;
+  std::vector<size_t> alias;
+
+public:
+  AliasTable() = default;
+
+  /**
+   * Builds table for distribution proportional to nonnegative @weights
+   */
+  explicit AliasTable(const std::vector<Real_t> &weights)
+      : probability(weights.size(), 1.0), alias(weights.size()) {
+    Real_t weights_sum = 0.0;
+    for (auto w : weights) {
+      weights_sum += w;
+    }
+    std::vector<Real_t> scaled;
+    std::vector<size_t> small;
+    std::vector<size_t> large;
+    for (size_t i = 0; i < weights.size(); i++) {
+      alias[i] = i;
+      scaled.push_back(weights[i] * weights.size() / weights_sum);
+      (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+      auto s = small.back();
+      auto l = large.back();
+      small.pop_back();
+      probability[s] = scaled[s];
+      alias[s] = l;
+      scaled[l] -= 1.0 - scaled[s];
+      if (scaled[l] < 1.0) {
+        large.pop_back();
+        small.push_back(l);
+      }
+    }
+    // Remaining columns are full up to rounding errors
+  }
+
+  size_t size() const { return probability.size(); }
+
+  size_t sample(Random<Real_t> &random) const {
+    const size_t column = random.next_int(probability.size());
+    return random.uniform() < probability[column] ? column : alias[column];
+  }
+};
+
+#endif // !ALIAS_TABLE_H
@@ -0,0 +1,157 @@
+#ifndef DENSE_MATRIX_H
+#define DENSE_MATRIX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ * Alignment of rows of dense matrices. Equal to the cache line size and to the
+ * width of AVX-512 registers.
+ */
+constexpr size_t MATRIX_ALIGNMENT = 64;
+
+/**
+ * Allocator of memory aligned to @Alignment bytes.
+ */
+template <class T, size_t Alignment = MATRIX_ALIGNMENT> class AlignedAllocator {
+public:
+  using value_type = T;
+
+  template <class U> struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+
+  template <class U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+  }
+
+  void deallocate(T *p, size_t) noexcept {
+    ::operator delete(p, std::align_val_t{Alignment});
+  }
+
+  template <class U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept {
+    return true;
+  }
+
+  template <class U>
+  bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept {
+    return false;
+  }
+};
+
+template <class T> using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+/**
+ * Dense row-major matrix stored in a single allocation.
+ *
+ * Every row starts at a @MATRIX_ALIGNMENT aligned address - row stride is
+ * padded to a multiple of the alignment. Row stride may exceed the number of
+ * columns by more than the padding if room for more columns is reserved.
+ * Padding is zero-filled and is not a part of the matrix.
+ */
+template <class Real_t> class DenseMatrix {
+  size_t rows_count{0};
+  size_t columns_count{0};
+  size_t row_stride{0};
+  AlignedVector<Real_t> data;
+
+  static size_t get_padded_size(size_t columns) {
+    const size_t per_alignment = MATRIX_ALIGNMENT / sizeof(Real_t);
+    return (columns + per_alignment - 1) / per_alignment * per_alignment;
+  }
+
+public:
+  DenseMatrix() = default;
+
+  DenseMatrix(size_t rows, size_t columns, Real_t value = 0.0)
+      : rows_count{rows}, columns_count{columns},
+        row_stride{get_padded_size(columns)}, data(rows * row_stride, 0.0) {
+    fill(value);
+  }
+
+  size_t rows() const { return rows_count; }
+
+  size_t columns() const { return columns_count; }
+
+  size_t stride() const { return row_stride; }
+
+  Real_t *operator[](size_t row) { return data.data() + row * row_stride; }
+
+  const Real_t *operator[](size_t row) const {
+    return data.data() + row * row_stride;
+  }
+
+  void fill(Real_t value) {
+    for (size_t row = 0; row < rows_count; row++) {
+      std::fill((*this)[row], (*this)[row] + columns_count, value);
+    }
+  }
+
+  /**
+   * Makes room for @columns columns, so that resizing up to @columns columns
+   * does not move the data.
+   */
+  void reserve_columns(size_t columns) {
+    const size_t new_stride = get_padded_size(columns);
+    if (new_stride <= row_stride) {
+      return;
+    }
+    AlignedVector<Real_t> new_data(rows_count * new_stride, 0.0);
+    for (size_t row = 0; row < rows_count; row++) {
+      std::copy((*this)[row], (*this)[row] + columns_count,
+                new_data.data() + row * new_stride);
+    }
+    data = std::move(new_data);
+    row_stride = new_stride;
+  }
+
+  /**
+   * Changes number of columns, keeping values of the preserved ones.
+   * New entries are set to @value. Row stride is never decreased and grows
+   * at least twice, so that adding columns one by one takes amortized
+   * constant time per entry.
+   */
+  void resize_columns(size_t columns, Real_t value = 0.0) {
+    if (get_padded_size(columns) > row_stride) {
+      reserve_columns(std::max(columns, 2 * row_stride));
+    }
+    for (size_t row = 0; row < rows_count; row++) {
+      if (columns > columns_count) {
+        std::fill((*this)[row] + columns_count, (*this)[row] + columns, value);
+      } else {
+        std::fill((*this)[row] + columns, (*this)[row] + columns_count, 0.0);
+      }
+    }
+    columns_count = columns;
+  }
+
+  /**
+   * Returns all entries row by row.
+   */
+  std::vector<Real_t> flatten() const {
+    std::vector<Real_t> result;
+    result.reserve(rows_count * columns_count);
+    for (size_t row = 0; row < rows_count; row++) {
+      result.insert(result.end(), (*this)[row], (*this)[row] + columns_count);
+    }
+    return result;
+  }
+
+  static void swap(DenseMatrix<Real_t> &m1, DenseMatrix<Real_t> &m2) {
+    std::swap(m1.rows_count, m2.rows_count);
+    std::swap(m1.columns_count, m2.columns_count);
+    std::swap(m1.row_stride, m2.row_stride);
+    std::swap(m1.data, m2.data);
+  }
+};
+
+#endif // !DENSE_MATRIX_H
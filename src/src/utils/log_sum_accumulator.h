@@ -2,6 +2,11 @@
 #define LOG_SUM_ACCUMULATOR_H
 
 #include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "dense_matrix.h"
+#include "simd_kernels.h"
 
 /**
  *	Iteratively calculates <code>log( exp(w_1) +...+ exp(w_n)) </code> for
@@ -36,4 +41,147 @@ public:
   Real_t get_result() const { return std::log(sum) + max; }
 };
 
+/**
+ * Structure of arrays of @LogWeightAccumulator - one accumulator per entry of
+ * a row (usually one per cell). Whole rows of weights are added and removed
+ * with vectorized kernels.
+ *
+ * Empty accumulator has max equal to -infinity, so the first added weight
+ * becomes its max.
+ */
+template <class Real_t> class LogWeightAccumulators {
+  /**
+   * If removals leave less than this fraction of the largest mass seen since
+   * the last clear, the result is dominated by rounding errors.
+   */
+  static constexpr Real_t CANCELLATION_THRESHOLD = 1e-6;
+  // Weights of other type are converted to @Real_t in blocks of this size
+  static constexpr size_t CONVERSION_BLOCK = 256;
+
+  AlignedVector<Real_t> max;
+  AlignedVector<Real_t> sum;
+  AlignedVector<Real_t> peak_sum;
+
+public:
+  LogWeightAccumulators(size_t size = 0)
+      : max(size, -std::numeric_limits<Real_t>::infinity()), sum(size, 0.0),
+        peak_sum(size, 0.0) {}
+
+  size_t size() const { return max.size(); }
+
+  void clear() { clear(0, size()); }
+
+  /**
+   * Clears accumulators from [@begin, @end).
+   */
+  void clear(size_t begin, size_t end) {
+    std::fill(max.begin() + begin, max.begin() + end,
+              -std::numeric_limits<Real_t>::infinity());
+    std::fill(sum.begin() + begin, sum.begin() + end, 0.0);
+    std::fill(peak_sum.begin() + begin, peak_sum.begin() + end, 0.0);
+  }
+
+  /**
+   * Sets accumulators from [@begin, @end) to the corresponding ones of
+   * @other.
+   */
+  void copy(const LogWeightAccumulators<Real_t> &other, size_t begin,
+            size_t end) {
+    std::copy(other.max.begin() + begin, other.max.begin() + end,
+              max.begin() + begin);
+    std::copy(other.sum.begin() + begin, other.sum.begin() + end,
+              sum.begin() + begin);
+    std::copy(other.peak_sum.begin() + begin, other.peak_sum.begin() + end,
+              peak_sum.begin() + begin);
+  }
+
+  /**
+   * Adds weight <code>weights[i] + offset</code> to i-th accumulator, for
+   * each accumulator. Weights may be of lower precision than accumulators.
+   */
+  template <class Weight_t> void add(const Weight_t *weights, Real_t offset) {
+    add(weights, offset, 0, size());
+  }
+
+  /**
+   * Same as <code>add(weights, offset)</code>, restricted to accumulators
+   * from [@begin, @end).
+   */
+  template <class Weight_t>
+  void add(const Weight_t *weights, Real_t offset, size_t begin, size_t end) {
+    if constexpr (std::is_same<Weight_t, Real_t>::value) {
+      Simd::log_sum_add(max.data() + begin, sum.data() + begin,
+                        peak_sum.data() + begin, weights + begin, offset,
+                        end - begin);
+    } else {
+      alignas(MATRIX_ALIGNMENT) Real_t converted[CONVERSION_BLOCK];
+      for (size_t i = begin; i < end; i += CONVERSION_BLOCK) {
+        const size_t block = std::min(CONVERSION_BLOCK, end - i);
+        std::copy(weights + i, weights + i + block, converted);
+        Simd::log_sum_add(max.data() + i, sum.data() + i, peak_sum.data() + i,
+                          converted, offset, block);
+      }
+    }
+  }
+
+  void add(size_t i, Real_t weight) {
+    Simd::Scalar::log_sum_add(&max[i], &sum[i], &peak_sum[i], &weight,
+                              (Real_t)0.0, 1);
+  }
+
+  /**
+   * Removes weights which have been previously added by
+   * <code>add(weights, offset)</code>.
+   */
+  template <class Weight_t>
+  void remove(const Weight_t *weights, Real_t offset) {
+    remove(weights, offset, 0, size());
+  }
+
+  template <class Weight_t>
+  void remove(const Weight_t *weights, Real_t offset, size_t begin,
+              size_t end) {
+    if constexpr (std::is_same<Weight_t, Real_t>::value) {
+      Simd::log_sum_remove(max.data() + begin, sum.data() + begin,
+                           weights + begin, offset, end - begin);
+    } else {
+      alignas(MATRIX_ALIGNMENT) Real_t converted[CONVERSION_BLOCK];
+      for (size_t i = begin; i < end; i += CONVERSION_BLOCK) {
+        const size_t block = std::min(CONVERSION_BLOCK, end - i);
+        std::copy(weights + i, weights + i + block, converted);
+        Simd::log_sum_remove(max.data() + i, sum.data() + i, converted, offset,
+                             block);
+      }
+    }
+  }
+
+  /**
+   * Returns true if removals cancelled out (almost) all of the mass
+   * accumulated by i-th accumulator. Its result is then unreliable and it
+   * should be refilled from scratch.
+   */
+  bool is_cancelled(size_t i) const {
+    return !(sum[i] > peak_sum[i] * CANCELLATION_THRESHOLD);
+  }
+
+  Real_t get_result(size_t i) const {
+    Real_t result;
+    Simd::Scalar::log_sum_result(&max[i], &sum[i], &result, 1);
+    return result;
+  }
+
+  void get_results(Real_t *results) const {
+    get_results(results, 0, size());
+  }
+
+  /**
+   * Writes results of accumulators from [@begin, @end) to the same positions
+   * of @results.
+   */
+  void get_results(Real_t *results, size_t begin, size_t end) const {
+    Simd::log_sum_result(max.data() + begin, sum.data() + begin,
+                         results + begin, end - begin);
+  }
+};
+
 #endif // !LOG_SUM_ACCUMULATOR_H
@@ -1,8 +1,11 @@
 #ifndef RANDOM_H
 #define RANDOM_H
+#include <algorithm>
 #include <cassert>
 #include <limits>
+#include <numeric>
 #include <random>
+#include <vector>
 
 /**
  * Encapsulates all random services which may be used by any CONET components.
@@ -46,7 +49,40 @@ public:
     return distribution(generator);
   }
 
+  /**
+   * Samples index with probability proportional to @weights, without
+   * allocating memory.
+   */
+  size_t categorical(const std::vector<Real_t> &weights) {
+    Real_t weights_sum = 0.0;
+    for (auto w : weights) {
+      weights_sum += w;
+    }
+    Real_t threshold = uniform() * weights_sum;
+    size_t index = 0;
+    while (index + 1 < weights.size() && threshold >= weights[index]) {
+      threshold -= weights[index];
+      index++;
+    }
+    return index;
+  }
+
   int random_int_bit() { return (int)next_int(2); }
+
+  /**
+   * Samples @k distinct numbers from <code>{0,.., n-1}</code> uniformly,
+   * returns them sorted
+   */
+  std::vector<size_t> subset(size_t n, size_t k) {
+    std::vector<size_t> numbers(n);
+    std::iota(numbers.begin(), numbers.end(), 0);
+    for (size_t i = 0; i < k; i++) {
+      std::swap(numbers[i], numbers[i + next_int(n - i)]);
+    }
+    numbers.resize(k);
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+  }
 };
 
 #endif // !RANDOM_H
@@ -0,0 +1,527 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SIMD_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * Vectorized kernels for operations on matrix rows which dominate tree
+ * likelihood calculation.
+ *
+ * Each kernel is implemented for SSE2, AVX2 and AVX-512. Implementation is
+ * chosen at runtime, based on instruction sets supported by the CPU. Kernels
+ * are defined for float and double. All implementations give bitwise
+ * identical results.
+ */
+namespace Simd {
+enum class InstructionSet { SCALAR, SSE, AVX2, AVX512 };
+
+inline std::string to_string(InstructionSet set) {
+  switch (set) {
+  case InstructionSet::SSE:
+    return "SSE";
+  case InstructionSet::AVX2:
+    return "AVX2";
+  case InstructionSet::AVX512:
+    return "AVX-512";
+  default:
+    return "scalar";
+  }
+}
+
+inline bool is_supported(InstructionSet set) {
+#ifdef SIMD_KERNELS_X86
+  switch (set) {
+  case InstructionSet::AVX512:
+    return __builtin_cpu_supports("avx512f");
+  case InstructionSet::AVX2:
+    return __builtin_cpu_supports("avx2");
+  default:
+    return true;
+  }
+#else
+  return set == InstructionSet::SCALAR;
+#endif
+}
+
+inline InstructionSet get_best_instruction_set() {
+  for (auto set : {InstructionSet::AVX512, InstructionSet::AVX2,
+                   InstructionSet::SSE}) {
+    if (is_supported(set)) {
+      return set;
+    }
+  }
+  return InstructionSet::SCALAR;
+}
+
+/**
+ * Kernel semantics, for i in [0, n):
+ *  add:        dst[i] += src[i]
+ *  add_rows:   dst[i] = a[i] + b[i]
+ *  subtract:   dst[i] -= src[i]
+ *  update_max: if row[i] > max[i] or (row[i] == max[i] and position <
+ *              max_positions[i]) then max[i] = row[i], max_positions[i] =
+ *              position. Per cell argmax search over nodes thus picks the
+ *              node with the smallest position among the maximal ones.
+ *  exp, log:   dst[i] = exp(src[i]), dst[i] = log(src[i])
+ *
+ * log_sum_* kernels operate on structure of arrays of log-sum-exp
+ * accumulators, see @LogWeightAccumulators.
+ */
+template <class Real_t> struct Kernels {
+  void (*add)(Real_t *dst, const Real_t *src, size_t n);
+  void (*add_rows)(Real_t *dst, const Real_t *a, const Real_t *b, size_t n);
+  void (*subtract)(Real_t *dst, const Real_t *src, size_t n);
+  void (*update_max)(Real_t *max, Real_t *max_positions, const Real_t *row,
+                     Real_t position, size_t n);
+  void (*exp)(Real_t *dst, const Real_t *src, size_t n);
+  void (*log)(Real_t *dst, const Real_t *src, size_t n);
+  void (*log_sum_add)(Real_t *max, Real_t *sum, Real_t *peak_sum,
+                      const Real_t *weights, Real_t offset, size_t n);
+  void (*log_sum_remove)(const Real_t *max, Real_t *sum, const Real_t *weights,
+                         Real_t offset, size_t n);
+  void (*log_sum_result)(const Real_t *max, const Real_t *sum, Real_t *result,
+                         size_t n);
+};
+
+/**
+ * Binary representation constants used by exp and log.
+ */
+template <class Real_t> struct FloatBits;
+
+template <> struct FloatBits<double> {
+  using Bits = uint64_t;
+  static constexpr int MANTISSA_BITS = 52;
+  static constexpr double EXPONENT_BIAS = 1023.0;
+  // 2^52, adding it to a small nonnegative integer places it in low bits
+  static constexpr double INTEGER_MAGIC = 4503599627370496.0;
+  static constexpr Bits INTEGER_MAGIC_BITS = 0x4330000000000000ULL;
+  static constexpr double ROUNDING_MAGIC = 6755399441055744.0;
+  static constexpr Bits MANTISSA_MASK = 0x000FFFFFFFFFFFFFULL;
+  static constexpr Bits HALF_BITS = 0x3FE0000000000000ULL;
+  static constexpr double MIN_EXP_ARG = -708.39641853226410622;
+  static constexpr double MAX_EXP_ARG = 709.0;
+  static constexpr double EXP_LN2_HIGH = 6.93145751953125E-1;
+  static constexpr double EXP_LN2_LOW = 1.42860682030941723212E-6;
+  static constexpr double LOG_LN2_HIGH = 0.693359375;
+  static constexpr double LOG_LN2_LOW = 2.121944400546905827679E-4;
+};
+
+template <> struct FloatBits<float> {
+  using Bits = uint32_t;
+  static constexpr int MANTISSA_BITS = 23;
+  static constexpr float EXPONENT_BIAS = 127.0f;
+  static constexpr float INTEGER_MAGIC = 8388608.0f;
+  static constexpr Bits INTEGER_MAGIC_BITS = 0x4B000000U;
+  static constexpr float ROUNDING_MAGIC = 12582912.0f;
+  static constexpr Bits MANTISSA_MASK = 0x007FFFFFU;
+  static constexpr Bits HALF_BITS = 0x3F000000U;
+  static constexpr float MIN_EXP_ARG = -87.3365447505531f;
+  static constexpr float MAX_EXP_ARG = 88.0f;
+  static constexpr float EXP_LN2_HIGH = 0.693359375f;
+  static constexpr float EXP_LN2_LOW = -2.12194440E-4f;
+  static constexpr float LOG_LN2_HIGH = 0.693359375f;
+  static constexpr float LOG_LN2_LOW = 2.12194440E-4f;
+};
+
+namespace Scalar {
+/**
+ * Vector of width one. Operations mirror the semantics of vector
+ * instructions, including handling of NaNs by min and max.
+ */
+template <class Real_t> struct Ops {
+  using Vec = Real_t;
+  using Mask = bool;
+  using Bits = typename FloatBits<Real_t>::Bits;
+  static constexpr size_t WIDTH = 1;
+  static Vec load(const Real_t *p) { return *p; }
+  static void store(Real_t *p, Vec v) { *p = v; }
+  static Vec set(Real_t v) { return v; }
+  static Vec add(Vec a, Vec b) { return a + b; }
+  static Vec sub(Vec a, Vec b) { return a - b; }
+  static Vec mul(Vec a, Vec b) { return a * b; }
+  static Vec div(Vec a, Vec b) { return a / b; }
+  static Vec min(Vec a, Vec b) { return a < b ? a : b; }
+  static Vec max(Vec a, Vec b) { return a > b ? a : b; }
+  static Mask less(Vec a, Vec b) { return a < b; }
+  static Mask equal(Vec a, Vec b) { return a == b; }
+  static Mask mask_and(Mask a, Mask b) { return a && b; }
+  static Mask mask_or(Mask a, Mask b) { return a || b; }
+  static Vec select(Mask m, Vec a, Vec b) { return m ? a : b; }
+  static Bits to_bits(Vec v) {
+    Bits bits;
+    std::memcpy(&bits, &v, sizeof(v));
+    return bits;
+  }
+  static Vec from_bits(Bits bits) {
+    Vec v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+  }
+  static Vec bit_and(Vec a, Vec b) {
+    return from_bits(to_bits(a) & to_bits(b));
+  }
+  static Vec bit_or(Vec a, Vec b) {
+    return from_bits(to_bits(a) | to_bits(b));
+  }
+  static Vec shift_left_mantissa(Vec v) {
+    return from_bits(to_bits(v) << FloatBits<Real_t>::MANTISSA_BITS);
+  }
+  static Vec shift_right_mantissa(Vec v) {
+    return from_bits(to_bits(v) >> FloatBits<Real_t>::MANTISSA_BITS);
+  }
+};
+
+#include "simd_kernels_impl.h"
+} // namespace Scalar
+
+#ifdef SIMD_KERNELS_X86
+/**
+ * Kernels of each instruction set are defined in a separate namespace compiled
+ * for the given target.
+ */
+namespace Sse {
+template <class Real_t> struct Ops;
+
+template <> struct Ops<double> {
+  using Vec = __m128d;
+  using Mask = __m128d;
+  static constexpr size_t WIDTH = 2;
+  static Vec load(const double *p) { return _mm_loadu_pd(p); }
+  static void store(double *p, Vec v) { _mm_storeu_pd(p, v); }
+  static Vec set(double v) { return _mm_set1_pd(v); }
+  static Vec add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+  static Vec sub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+  static Vec mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+  static Vec div(Vec a, Vec b) { return _mm_div_pd(a, b); }
+  static Vec min(Vec a, Vec b) { return _mm_min_pd(a, b); }
+  static Vec max(Vec a, Vec b) { return _mm_max_pd(a, b); }
+  static Mask less(Vec a, Vec b) { return _mm_cmplt_pd(a, b); }
+  static Mask equal(Vec a, Vec b) { return _mm_cmpeq_pd(a, b); }
+  static Mask mask_and(Mask a, Mask b) { return _mm_and_pd(a, b); }
+  static Mask mask_or(Mask a, Mask b) { return _mm_or_pd(a, b); }
+  static Vec select(Mask m, Vec a, Vec b) {
+    return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+  }
+  static Vec from_bits(uint64_t bits) {
+    return _mm_castsi128_pd(_mm_set1_epi64x(bits));
+  }
+  static Vec bit_and(Vec a, Vec b) { return _mm_and_pd(a, b); }
+  static Vec bit_or(Vec a, Vec b) { return _mm_or_pd(a, b); }
+  static Vec shift_left_mantissa(Vec v) {
+    return _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(v), 52));
+  }
+  static Vec shift_right_mantissa(Vec v) {
+    return _mm_castsi128_pd(_mm_srli_epi64(_mm_castpd_si128(v), 52));
+  }
+};
+
+template <> struct Ops<float> {
+  using Vec = __m128;
+  using Mask = __m128;
+  static constexpr size_t WIDTH = 4;
+  static Vec load(const float *p) { return _mm_loadu_ps(p); }
+  static void store(float *p, Vec v) { _mm_storeu_ps(p, v); }
+  static Vec set(float v) { return _mm_set1_ps(v); }
+  static Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+  static Vec sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+  static Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+  static Vec div(Vec a, Vec b) { return _mm_div_ps(a, b); }
+  static Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+  static Vec max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+  static Mask less(Vec a, Vec b) { return _mm_cmplt_ps(a, b); }
+  static Mask equal(Vec a, Vec b) { return _mm_cmpeq_ps(a, b); }
+  static Mask mask_and(Mask a, Mask b) { return _mm_and_ps(a, b); }
+  static Mask mask_or(Mask a, Mask b) { return _mm_or_ps(a, b); }
+  static Vec select(Mask m, Vec a, Vec b) {
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+  }
+  static Vec from_bits(uint32_t bits) {
+    return _mm_castsi128_ps(_mm_set1_epi32(bits));
+  }
+  static Vec bit_and(Vec a, Vec b) { return _mm_and_ps(a, b); }
+  static Vec bit_or(Vec a, Vec b) { return _mm_or_ps(a, b); }
+  static Vec shift_left_mantissa(Vec v) {
+    return _mm_castsi128_ps(_mm_slli_epi32(_mm_castps_si128(v), 23));
+  }
+  static Vec shift_right_mantissa(Vec v) {
+    return _mm_castsi128_ps(_mm_srli_epi32(_mm_castps_si128(v), 23));
+  }
+};
+
+#include "simd_kernels_impl.h"
+} // namespace Sse
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace Avx2 {
+template <class Real_t> struct Ops;
+
+template <> struct Ops<double> {
+  using Vec = __m256d;
+  using Mask = __m256d;
+  static constexpr size_t WIDTH = 4;
+  static Vec load(const double *p) { return _mm256_loadu_pd(p); }
+  static void store(double *p, Vec v) { _mm256_storeu_pd(p, v); }
+  static Vec set(double v) { return _mm256_set1_pd(v); }
+  static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+  static Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+  static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+  static Vec div(Vec a, Vec b) { return _mm256_div_pd(a, b); }
+  static Vec min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+  static Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+  static Mask less(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+  static Mask equal(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+  static Mask mask_and(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+  static Mask mask_or(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+  static Vec select(Mask m, Vec a, Vec b) { return _mm256_blendv_pd(b, a, m); }
+  static Vec from_bits(uint64_t bits) {
+    return _mm256_castsi256_pd(_mm256_set1_epi64x(bits));
+  }
+  static Vec bit_and(Vec a, Vec b) { return _mm256_and_pd(a, b); }
+  static Vec bit_or(Vec a, Vec b) { return _mm256_or_pd(a, b); }
+  static Vec shift_left_mantissa(Vec v) {
+    return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(v), 52));
+  }
+  static Vec shift_right_mantissa(Vec v) {
+    return _mm256_castsi256_pd(_mm256_srli_epi64(_mm256_castpd_si256(v), 52));
+  }
+};
+
+template <> struct Ops<float> {
+  using Vec = __m256;
+  using Mask = __m256;
+  static constexpr size_t WIDTH = 8;
+  static Vec load(const float *p) { return _mm256_loadu_ps(p); }
+  static void store(float *p, Vec v) { _mm256_storeu_ps(p, v); }
+  static Vec set(float v) { return _mm256_set1_ps(v); }
+  static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+  static Vec sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+  static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+  static Vec div(Vec a, Vec b) { return _mm256_div_ps(a, b); }
+  static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+  static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+  static Mask less(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  static Mask equal(Vec a, Vec b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+  static Mask mask_and(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+  static Mask mask_or(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+  static Vec select(Mask m, Vec a, Vec b) { return _mm256_blendv_ps(b, a, m); }
+  static Vec from_bits(uint32_t bits) {
+    return _mm256_castsi256_ps(_mm256_set1_epi32(bits));
+  }
+  static Vec bit_and(Vec a, Vec b) { return _mm256_and_ps(a, b); }
+  static Vec bit_or(Vec a, Vec b) { return _mm256_or_ps(a, b); }
+  static Vec shift_left_mantissa(Vec v) {
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_castps_si256(v), 23));
+  }
+  static Vec shift_right_mantissa(Vec v) {
+    return _mm256_castsi256_ps(_mm256_srli_epi32(_mm256_castps_si256(v), 23));
+  }
+};
+
+#include "simd_kernels_impl.h"
+} // namespace Avx2
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+namespace Avx512 {
+template <class Real_t> struct Ops;
+
+// Unmasked AVX-512 min, max and shifts of GCC headers merge results into
+// undefined registers, which -Wall reports as uninitialized. Zero masking
+// with all lanes selected compiles to the same instructions.
+
+template <> struct Ops<double> {
+  using Vec = __m512d;
+  using Mask = __mmask8;
+  static constexpr Mask ALL_LANES = (__mmask8)-1;
+  static constexpr size_t WIDTH = 8;
+  static Vec load(const double *p) { return _mm512_loadu_pd(p); }
+  static void store(double *p, Vec v) { _mm512_storeu_pd(p, v); }
+  static Vec set(double v) { return _mm512_set1_pd(v); }
+  static Vec add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+  static Vec sub(Vec a, Vec b) { return _mm512_sub_pd(a, b); }
+  static Vec mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+  static Vec div(Vec a, Vec b) { return _mm512_div_pd(a, b); }
+  static Vec min(Vec a, Vec b) {
+    return _mm512_maskz_min_pd(ALL_LANES, a, b);
+  }
+  static Vec max(Vec a, Vec b) {
+    return _mm512_maskz_max_pd(ALL_LANES, a, b);
+  }
+  static Mask less(Vec a, Vec b) {
+    return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ);
+  }
+  static Mask equal(Vec a, Vec b) {
+    return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ);
+  }
+  static Mask mask_and(Mask a, Mask b) { return a & b; }
+  static Mask mask_or(Mask a, Mask b) { return a | b; }
+  static Vec select(Mask m, Vec a, Vec b) {
+    return _mm512_mask_blend_pd(m, b, a);
+  }
+  static Vec from_bits(uint64_t bits) {
+    return _mm512_castsi512_pd(_mm512_set1_epi64(bits));
+  }
+  static Vec bit_and(Vec a, Vec b) {
+    return _mm512_castsi512_pd(
+        _mm512_and_si512(_mm512_castpd_si512(a), _mm512_castpd_si512(b)));
+  }
+  static Vec bit_or(Vec a, Vec b) {
+    return _mm512_castsi512_pd(
+        _mm512_or_si512(_mm512_castpd_si512(a), _mm512_castpd_si512(b)));
+  }
+  static Vec shift_left_mantissa(Vec v) {
+    return _mm512_castsi512_pd(
+        _mm512_maskz_slli_epi64(ALL_LANES, _mm512_castpd_si512(v), 52));
+  }
+  static Vec shift_right_mantissa(Vec v) {
+    return _mm512_castsi512_pd(
+        _mm512_maskz_srli_epi64(ALL_LANES, _mm512_castpd_si512(v), 52));
+  }
+};
+
+template <> struct Ops<float> {
+  using Vec = __m512;
+  using Mask = __mmask16;
+  static constexpr Mask ALL_LANES = (__mmask16)-1;
+  static constexpr size_t WIDTH = 16;
+  static Vec load(const float *p) { return _mm512_loadu_ps(p); }
+  static void store(float *p, Vec v) { _mm512_storeu_ps(p, v); }
+  static Vec set(float v) { return _mm512_set1_ps(v); }
+  static Vec add(Vec a, Vec b) { return _mm512_add_ps(a, b); }
+  static Vec sub(Vec a, Vec b) { return _mm512_sub_ps(a, b); }
+  static Vec mul(Vec a, Vec b) { return _mm512_mul_ps(a, b); }
+  static Vec div(Vec a, Vec b) { return _mm512_div_ps(a, b); }
+  static Vec min(Vec a, Vec b) {
+    return _mm512_maskz_min_ps(ALL_LANES, a, b);
+  }
+  static Vec max(Vec a, Vec b) {
+    return _mm512_maskz_max_ps(ALL_LANES, a, b);
+  }
+  static Mask less(Vec a, Vec b) {
+    return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);
+  }
+  static Mask equal(Vec a, Vec b) {
+    return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ);
+  }
+  static Mask mask_and(Mask a, Mask b) { return a & b; }
+  static Mask mask_or(Mask a, Mask b) { return a | b; }
+  static Vec select(Mask m, Vec a, Vec b) {
+    return _mm512_mask_blend_ps(m, b, a);
+  }
+  static Vec from_bits(uint32_t bits) {
+    return _mm512_castsi512_ps(_mm512_set1_epi32(bits));
+  }
+  static Vec bit_and(Vec a, Vec b) {
+    return _mm512_castsi512_ps(
+        _mm512_and_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+  }
+  static Vec bit_or(Vec a, Vec b) {
+    return _mm512_castsi512_ps(
+        _mm512_or_si512(_mm512_castps_si512(a), _mm512_castps_si512(b)));
+  }
+  static Vec shift_left_mantissa(Vec v) {
+    return _mm512_castsi512_ps(
+        _mm512_maskz_slli_epi32(ALL_LANES, _mm512_castps_si512(v), 23));
+  }
+  static Vec shift_right_mantissa(Vec v) {
+    return _mm512_castsi512_ps(
+        _mm512_maskz_srli_epi32(ALL_LANES, _mm512_castps_si512(v), 23));
+  }
+};
+
+#include "simd_kernels_impl.h"
+} // namespace Avx512
+#pragma GCC pop_options
+#endif // SIMD_KERNELS_X86
+
+/**
+ * Returns kernels for instruction set @set, which must be supported by the CPU.
+ */
+template <class Real_t> Kernels<Real_t> get_kernels(InstructionSet set) {
+  static_assert(std::is_same_v<Real_t, double> ||
+                    std::is_same_v<Real_t, float>,
+                "Simd kernels are implemented for float and double only");
+#ifdef SIMD_KERNELS_X86
+  switch (set) {
+  case InstructionSet::AVX512:
+    return Avx512::get_kernels<Real_t>();
+  case InstructionSet::AVX2:
+    return Avx2::get_kernels<Real_t>();
+  case InstructionSet::SSE:
+    return Sse::get_kernels<Real_t>();
+  default:
+    break;
+  }
+#endif
+  return Scalar::get_kernels<Real_t>();
+}
+
+/**
+ * Kernels for the best instruction set supported by the CPU.
+ */
+template <class Real_t> const Kernels<Real_t> &get_kernels() {
+  static const Kernels<Real_t> kernels =
+      get_kernels<Real_t>(get_best_instruction_set());
+  return kernels;
+}
+
+template <class Real_t> void add(Real_t *dst, const Real_t *src, size_t n) {
+  get_kernels<Real_t>().add(dst, src, n);
+}
+
+template <class Real_t>
+void add_rows(Real_t *dst, const Real_t *a, const Real_t *b, size_t n) {
+  get_kernels<Real_t>().add_rows(dst, a, b, n);
+}
+
+template <class Real_t>
+void subtract(Real_t *dst, const Real_t *src, size_t n) {
+  get_kernels<Real_t>().subtract(dst, src, n);
+}
+
+template <class Real_t>
+void update_max(Real_t *max, Real_t *max_positions, const Real_t *row,
+                Real_t position, size_t n) {
+  get_kernels<Real_t>().update_max(max, max_positions, row, position, n);
+}
+
+template <class Real_t> void exp(Real_t *dst, const Real_t *src, size_t n) {
+  get_kernels<Real_t>().exp(dst, src, n);
+}
+
+template <class Real_t> void log(Real_t *dst, const Real_t *src, size_t n) {
+  get_kernels<Real_t>().log(dst, src, n);
+}
+
+template <class Real_t>
+void log_sum_add(Real_t *max, Real_t *sum, Real_t *peak_sum,
+                 const Real_t *weights, Real_t offset, size_t n) {
+  get_kernels<Real_t>().log_sum_add(max, sum, peak_sum, weights, offset, n);
+}
+
+template <class Real_t>
+void log_sum_remove(const Real_t *max, Real_t *sum, const Real_t *weights,
+                    Real_t offset, size_t n) {
+  get_kernels<Real_t>().log_sum_remove(max, sum, weights, offset, n);
+}
+
+template <class Real_t>
+void log_sum_result(const Real_t *max, const Real_t *sum, Real_t *result,
+                    size_t n) {
+  get_kernels<Real_t>().log_sum_result(max, sum, result, n);
+}
+} // namespace Simd
+
+#endif // !SIMD_KERNELS_H
@@ -0,0 +1,271 @@
+// Kernel bodies shared by all instruction sets.
+//
+// This file is included by simd_kernels.h once per instruction set, inside
+// the namespace of the instruction set, after definition of Ops<double> and
+// Ops<float> for it. It must not be included anywhere else.
+//
+// Vectorized loops process full vectors, remaining elements are processed by
+// Scalar kernels. Scalar::Ops performs exactly the same floating point
+// operations as vector Ops, so results do not depend on the instruction set.
+
+template <class Real_t> void add(Real_t *dst, const Real_t *src, size_t n) {
+  using O = Ops<Real_t>;
+  size_t i = 0;
+  for (; i + O::WIDTH <= n; i += O::WIDTH) {
+    O::store(dst + i, O::add(O::load(dst + i), O::load(src + i)));
+  }
+  if (O::WIDTH > 1 && i < n) {
+    Scalar::add(dst + i, src + i, n - i);
+  }
+}
+
+template <class Real_t>
+void add_rows(Real_t *dst, const Real_t *a, const Real_t *b, size_t n) {
+  using O = Ops<Real_t>;
+  size_t i = 0;
+  for (; i + O::WIDTH <= n; i += O::WIDTH) {
+    O::store(dst + i, O::add(O::load(a + i), O::load(b + i)));
+  }
+  if (O::WIDTH > 1 && i < n) {
+    Scalar::add_rows(dst + i, a + i, b + i, n - i);
+  }
+}
+
+template <class Real_t>
+void subtract(Real_t *dst, const Real_t *src, size_t n) {
+  using O = Ops<Real_t>;
+  size_t i = 0;
+  for (; i + O::WIDTH <= n; i += O::WIDTH) {
+    O::store(dst + i, O::sub(O::load(dst + i), O::load(src + i)));
+  }
+  if (O::WIDTH > 1 && i < n) {
+    Scalar::subtract(dst + i, src + i, n - i);
+  }
+}
+
+template <class Real_t>
+void update_max(Real_t *max, Real_t *max_positions, const Real_t *row,
+                Real_t position, size_t n) {
+  using O = Ops<Real_t>;
+  const auto pos = O::set(position);
+  size_t i = 0;
+  for (; i + O::WIDTH <= n; i += O::WIDTH) {
+    const auto current = O::load(max + i);
+    const auto candidate = O::load(row + i);
+    const auto current_pos = O::load(max_positions + i);
+    const auto better = O::mask_or(
+        O::less(current, candidate),
+        O::mask_and(O::equal(current, candidate), O::less(pos, current_pos)));
+    O::store(max + i, O::select(better, candidate, current));
+    O::store(max_positions + i, O::select(better, pos, current_pos));
+  }
+  if (O::WIDTH > 1 && i < n) {
+    Scalar::update_max(max + i, max_positions + i, row + i, position, n - i);
+  }
+}
+
+/**
+ * Rounds @x to the nearest integer, @x must be smaller than 2^(mantissa bits
+ * - 1) in absolute value.
+ */
+template <class Real_t>
+typename Ops<Real_t>::Vec round_vec(typename Ops<Real_t>::Vec x) {
+  using O = Ops<Real_t>;
+  const auto magic = O::set(FloatBits<Real_t>::ROUNDING_MAGIC);
+  return O::sub(O::add(x, magic), magic);
+}
+
+/**
+ * 2^n for integer valued @n within the range of normal exponents.
+ */
+template <class Real_t>
+typename Ops<Real_t>::Vec pow2_vec(typename Ops<Real_t>::Vec n) {
+  using O = Ops<Real_t>;
+  using B = FloatBits<Real_t>;
+  return O::shift_left_mantissa(
+      O::add(n, O::set(B::INTEGER_MAGIC + B::EXPONENT_BIAS)));
+}
+
+/**
+ * Cephes exp. Arguments smaller than @FloatBits::MIN_EXP_ARG give 0, larger
+ * than @FloatBits::MAX_EXP_ARG give infinity.
+ */
+template <class Real_t>
+typename Ops<Real_t>::Vec exp_vec(typename Ops<Real_t>::Vec x) {
+  using O = Ops<Real_t>;
+  using B = FloatBits<Real_t>;
+  const auto one = O::set(1.0);
+  const auto arg = O::max(O::min(x, O::set(B::MAX_EXP_ARG)),
+                          O::set(B::MIN_EXP_ARG));
+  const auto n = round_vec<Real_t>(O::mul(arg, O::set(1.44269504088896341)));
+  auto r = O::sub(arg, O::mul(n, O::set(B::EXP_LN2_HIGH)));
+  r = O::sub(r, O::mul(n, O::set(B::EXP_LN2_LOW)));
+  typename O::Vec result;
+  if constexpr (std::is_same_v<Real_t, double>) {
+    const auto rr = O::mul(r, r);
+    auto p = O::add(O::mul(O::set(1.26177193074810590878E-4), rr),
+                    O::set(3.02994407707441961300E-2));
+    p = O::mul(r, O::add(O::mul(p, rr), O::set(9.99999999999999999910E-1)));
+    auto q = O::add(O::mul(O::set(3.00198505138664455042E-6), rr),
+                    O::set(2.52448340349684104192E-3));
+    q = O::add(O::mul(q, rr), O::set(2.27265548208155028766E-1));
+    q = O::add(O::mul(q, rr), O::set(2.00000000000000000009E0));
+    result = O::add(one, O::mul(O::set(2.0), O::div(p, O::sub(q, p))));
+  } else {
+    auto p =
+        O::add(O::mul(O::set(1.9875691500E-4), r), O::set(1.3981999507E-3));
+    p = O::add(O::mul(p, r), O::set(8.3334519073E-3));
+    p = O::add(O::mul(p, r), O::set(4.1665795894E-2));
+    p = O::add(O::mul(p, r), O::set(1.6666665459E-1));
+    p = O::add(O::mul(p, r), O::set(5.0000001201E-1));
+    result = O::add(O::add(O::mul(p, O::mul(r, r)), r), one);
+  }
+  result = O::mul(result, pow2_vec<Real_t>(n));
+  result = O::select(O::less(x, O::set(B::MIN_EXP_ARG)), O::set(0.0), result);
+  return O::select(O::less(O::set(B::MAX_EXP_ARG), x),
+                   O::set(std::numeric_limits<Real_t>::infinity()), result);
+}
+
+/**
+ * Cephes log. Subnormal arguments are not supported.
+ */
+template <class Real_t>
+typename Ops<Real_t>::Vec log_vec(typename Ops<Real_t>::Vec x) {
+  using O = Ops<Real_t>;
+  using B = FloatBits<Real_t>;
+  const auto one = O::set(1.0);
+  const auto zero = O::set(0.0);
+  // x = m * 2^e, m in [0.5, 1)
+  auto e = O::sub(O::bit_or(O::shift_right_mantissa(x),
+                            O::from_bits(B::INTEGER_MAGIC_BITS)),
+                  O::set(B::INTEGER_MAGIC + B::EXPONENT_BIAS - 1));
+  auto m = O::bit_or(O::bit_and(x, O::from_bits(B::MANTISSA_MASK)),
+                     O::from_bits(B::HALF_BITS));
+  const auto small = O::less(m, O::set(0.70710678118654752440));
+  e = O::select(small, O::sub(e, one), e);
+  m = O::select(small, O::sub(O::add(m, m), one), O::sub(m, one));
+  const auto z = O::mul(m, m);
+  typename O::Vec y;
+  if constexpr (std::is_same_v<Real_t, double>) {
+    auto p = O::add(O::mul(O::set(1.01875663804580931796E-4), m),
+                    O::set(4.97494994976747001425E-1));
+    p = O::add(O::mul(p, m), O::set(4.70579119878881725854E0));
+    p = O::add(O::mul(p, m), O::set(1.44989225341610930846E1));
+    p = O::add(O::mul(p, m), O::set(1.79368678507819816313E1));
+    p = O::add(O::mul(p, m), O::set(7.70838733755885391666E0));
+    auto q = O::add(m, O::set(1.12873587189167450590E1));
+    q = O::add(O::mul(q, m), O::set(4.52279145837532221105E1));
+    q = O::add(O::mul(q, m), O::set(8.29875266912776603211E1));
+    q = O::add(O::mul(q, m), O::set(7.11544750618563894466E1));
+    q = O::add(O::mul(q, m), O::set(2.31251620126765340583E1));
+    y = O::mul(m, O::div(O::mul(z, p), q));
+  } else {
+    auto p = O::add(O::mul(O::set(7.0376836292E-2), m),
+                    O::set(-1.1514610310E-1));
+    p = O::add(O::mul(p, m), O::set(1.1676998740E-1));
+    p = O::add(O::mul(p, m), O::set(-1.2420140846E-1));
+    p = O::add(O::mul(p, m), O::set(1.4249322787E-1));
+    p = O::add(O::mul(p, m), O::set(-1.6668057665E-1));
+    p = O::add(O::mul(p, m), O::set(2.0000714765E-1));
+    p = O::add(O::mul(p, m), O::set(-2.4999993993E-1));
+    p = O::add(O::mul(p, m), O::set(3.3333331174E-1));
+    y = O::mul(O::mul(p, m), z);
+  }
+  y = O::sub(y, O::mul(e, O::set(B::LOG_LN2_LOW)));
+  y = O::sub(y, O::mul(O::set(0.5), z));
+  auto result = O::add(O::add(m, y), O::mul(e, O::set(B::LOG_LN2_HIGH)));
+
+  result = O::select(O::less(zero, x), result,
+                     O::set(std::numeric_limits<Real_t>::quiet_NaN()));
+  result = O::select(O::equal(x, zero),
+                     O::set(-std::numeric_limits<Real_t>::infinity()), result);
+  const auto inf = O::set(std::numeric_limits<Real_t>::infinity());
+  return O::select(O::equal(x, inf), inf, result);
+}
+
+template <class Real_t> void exp(Real_t *dst, const Real_t *src, size_t n) {
+  using O = Ops<Real_t>;
+  size_t i = 0;
+  for (; i + O::WIDTH <= n; i += O::WIDTH) {
+    O::store(dst + i, exp_vec<Real_t>(O::load(src + i)));
+  }
+  if (O::WIDTH > 1 && i < n) {
+    Scalar::exp(dst + i, src + i, n - i);
+  }
+}
+
+template <class Real_t> void log(Real_t *dst, const Real_t *src, size_t n) {
+  using O = Ops<Real_t>;
+  size_t i = 0;
+  for (; i + O::WIDTH <= n; i += O::WIDTH) {
+    O::store(dst + i, log_vec<Real_t>(O::load(src + i)));
+  }
+  if (O::WIDTH > 1 && i < n) {
+    Scalar::log(dst + i, src + i, n - i);
+  }
+}
+
+template <class Real_t>
+void log_sum_add(Real_t *max, Real_t *sum, Real_t *peak_sum,
+                 const Real_t *weights, Real_t offset, size_t n) {
+  using O = Ops<Real_t>;
+  const auto zero = O::set(0.0);
+  const auto one = O::set(1.0);
+  const auto off = O::set(offset);
+  size_t i = 0;
+  for (; i + O::WIDTH <= n; i += O::WIDTH) {
+    const auto w = O::add(O::load(weights + i), off);
+    const auto current_max = O::load(max + i);
+    auto s = O::load(sum + i);
+    auto peak = O::load(peak_sum + i);
+    const auto diff = O::sub(w, current_max);
+    // exp(-|w - max|)
+    const auto scale = exp_vec<Real_t>(O::min(diff, O::sub(zero, diff)));
+    const auto new_max = O::less(zero, diff);
+    s = O::select(new_max, O::add(O::mul(s, scale), one), O::add(s, scale));
+    peak = O::max(O::select(new_max, O::mul(peak, scale), peak), s);
+    O::store(sum + i, s);
+    O::store(peak_sum + i, peak);
+    O::store(max + i, O::select(new_max, w, current_max));
+  }
+  if (O::WIDTH > 1 && i < n) {
+    Scalar::log_sum_add(max + i, sum + i, peak_sum + i, weights + i, offset,
+                        n - i);
+  }
+}
+
+template <class Real_t>
+void log_sum_remove(const Real_t *max, Real_t *sum, const Real_t *weights,
+                    Real_t offset, size_t n) {
+  using O = Ops<Real_t>;
+  const auto off = O::set(offset);
+  size_t i = 0;
+  for (; i + O::WIDTH <= n; i += O::WIDTH) {
+    const auto diff =
+        O::sub(O::add(O::load(weights + i), off), O::load(max + i));
+    O::store(sum + i, O::sub(O::load(sum + i), exp_vec<Real_t>(diff)));
+  }
+  if (O::WIDTH > 1 && i < n) {
+    Scalar::log_sum_remove(max + i, sum + i, weights + i, offset, n - i);
+  }
+}
+
+template <class Real_t>
+void log_sum_result(const Real_t *max, const Real_t *sum, Real_t *result,
+                    size_t n) {
+  using O = Ops<Real_t>;
+  size_t i = 0;
+  for (; i + O::WIDTH <= n; i += O::WIDTH) {
+    O::store(result + i,
+             O::add(log_vec<Real_t>(O::load(sum + i)), O::load(max + i)));
+  }
+  if (O::WIDTH > 1 && i < n) {
+    Scalar::log_sum_result(max + i, sum + i, result + i, n - i);
+  }
+}
+
+template <class Real_t> Kernels<Real_t> get_kernels() {
+  return {add<Real_t>,         add_rows<Real_t>,       subtract<Real_t>,
+          update_max<Real_t>,  exp<Real_t>,            log<Real_t>,
+          log_sum_add<Real_t>, log_sum_remove<Real_t>, log_sum_result<Real_t>};
+}
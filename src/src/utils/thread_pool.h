@@ -0,0 +1,107 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Persistent pool of worker threads executing batches of independent tasks.
+ *
+ * Calling thread takes part in the execution of its batch, so a pool of size
+ * n uses n - 1 workers. Workers are started on the first batch which has more
+ * than one task and sleep between batches.
+ */
+class ThreadPool {
+  const size_t size;
+  std::vector<std::thread> workers;
+
+  std::mutex mutex;
+  std::condition_variable batch_started;
+  std::condition_variable batch_finished;
+  const std::function<void(size_t)> *task{nullptr};
+  size_t tasks_count{0};
+  size_t next_task{0};
+  size_t finished_tasks{0};
+  size_t batch{0};
+  bool stopping{false};
+
+  /**
+   * Executes tasks of the current batch until there are none left. @lock
+   * must be held on entry and is held on exit.
+   */
+  void execute_tasks(std::unique_lock<std::mutex> &lock) {
+    while (next_task < tasks_count) {
+      const size_t t = next_task++;
+      lock.unlock();
+      (*task)(t);
+      lock.lock();
+      if (++finished_tasks == tasks_count) {
+        batch_finished.notify_all();
+      }
+    }
+  }
+
+  void worker_loop() {
+    size_t last_batch = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      batch_started.wait(lock,
+                         [&] { return stopping || batch != last_batch; });
+      if (stopping) {
+        return;
+      }
+      last_batch = batch;
+      execute_tasks(lock);
+    }
+  }
+
+public:
+  ThreadPool(size_t size) : size{size == 0 ? 1 : size} {}
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    batch_started.notify_all();
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+  size_t get_size() const { return size; }
+
+  /**
+   * Executes <code>task(0),..., task(tasks - 1)</code>, possibly in parallel,
+   * and waits for all of them to finish.
+   */
+  void run(size_t tasks, const std::function<void(size_t)> &task) {
+    if (tasks <= 1 || size == 1) {
+      for (size_t t = 0; t < tasks; t++) {
+        task(t);
+      }
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    while (workers.size() + 1 < size) {
+      workers.emplace_back([this] { worker_loop(); });
+    }
+    this->task = &task;
+    tasks_count = tasks;
+    next_task = 0;
+    finished_tasks = 0;
+    batch++;
+    batch_started.notify_all();
+    execute_tasks(lock);
+    batch_finished.wait(lock, [&] { return finished_tasks == tasks_count; });
+    this->task = nullptr;
+  }
+};
+
+#endif // !THREAD_POOL_H
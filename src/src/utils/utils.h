@@ -23,12 +23,32 @@ public:
   MaxValueAccumulator() : value{0.0}, data{} {}
 
   void update(T p, Real_t v) {
-    if (!data.has_value() || v > value) {
+    if (improves(v)) {
       data.emplace(p);
       value = v;
     }
   }
 
+  bool improves(Real_t v) const { return !data.has_value() || v > value; }
+
+  /**
+   * Same as update, but the value is produced only if @v is a new maximum.
+   * @create returns the first value, later values are written by @assign
+   * over the stored one, so that its memory can be reused.
+   */
+  template <class Create, class Assign>
+  void update_lazily(Real_t v, Create create, Assign assign) {
+    if (!improves(v)) {
+      return;
+    }
+    if (data.has_value()) {
+      assign(*data);
+    } else {
+      data.emplace(create());
+    }
+    value = v;
+  }
+
   T get() { return data.value(); }
 };
 } // namespace Utils
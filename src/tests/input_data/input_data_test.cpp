@@ -0,0 +1,83 @@
+#include <iostream>
+#include <vector>
+
+#include "../../src/input_data/input_data.h"
+#include "../test_utils.h"
+
+const size_t LOCI = 300;
+const size_t CELLS = 4000;
+
+CONETInputData<float> create_input_data(bool reserve, size_t &reallocations) {
+    std::vector<size_t> chromosome_markers{LOCI / 2, LOCI};
+    std::vector<float> between_bins_lengths(LOCI, 1.0);
+    CONETInputData<float> data(LOCI, chromosome_markers, between_bins_lengths);
+    if (reserve) {
+        data.reserve_cells(CELLS);
+    }
+    reallocations = 0;
+    const float *counts = nullptr;
+    std::vector<float> cell(LOCI);
+    for (size_t c = 0; c < CELLS; c++) {
+        for (size_t i = 0; i < LOCI; i++) {
+            cell[i] = -(float)(c * LOCI + i);
+        }
+        data.post_cell(cell);
+        reallocations += counts != data.get_corrected_counts()[0];
+        counts = data.get_corrected_counts()[0];
+    }
+    std::vector<float> regions(LOCI, 1.0);
+    std::vector<std::vector<float>> counts_data(CELLS, std::vector<float>(LOCI, 2.0));
+    data.post_counts_dispersion_data(regions, counts_data, counts_data);
+    return data;
+}
+
+/**
+ * Posting cells one by one should move the counts matrix only a logarithmic
+ * number of times, and not at all if room for all cells has been reserved.
+ */
+void load_cells_test() {
+    BEGIN_TEST;
+    for (bool reserve : {false, true}) {
+        size_t reallocations = 0;
+        auto data = create_input_data(reserve, reallocations);
+        IS_TRUE(reallocations <= (reserve ? 1 : 16));
+        auto &counts = data.get_corrected_counts();
+        IS_EQUAL(data.get_cells_count(), CELLS);
+        IS_EQUAL(counts.columns(), CELLS);
+        for (size_t c = 0; c < CELLS; c += 7) {
+            for (size_t i = 0; i < LOCI; i++) {
+                IS_EQUAL(counts[i][c], -(float)(c * LOCI + i));
+            }
+        }
+        for (size_t i = 0; i < LOCI; i++) {
+            for (size_t c = CELLS; c < counts.stride(); c++) {
+                IS_EQUAL(counts[i][c], 0.0f);
+            }
+        }
+    }
+    END_TEST;
+}
+
+void cells_subset_test() {
+    BEGIN_TEST;
+    size_t reallocations = 0;
+    auto data = create_input_data(false, reallocations);
+    std::vector<size_t> cells;
+    for (size_t c = 0; c < CELLS; c += 3) {
+        cells.push_back(CELLS - 1 - c);
+    }
+    auto subset = data.get_cells_subset(cells);
+    IS_EQUAL(subset.get_cells_count(), cells.size());
+    for (size_t j = 0; j < cells.size(); j++) {
+        for (size_t i = 0; i < LOCI; i++) {
+            IS_EQUAL(subset.get_corrected_counts()[i][j],
+                     data.get_corrected_counts()[i][cells[j]]);
+        }
+    }
+    END_TEST;
+}
+
+int main(void) {
+    load_cells_test();
+    cells_subset_test();
+}
@@ -0,0 +1,82 @@
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+#include "../../src/likelihood_coordinator.h"
+#include "../../src/tree/tree_sampler.h"
+#include "../../src/tree_sampler_coordinator.h"
+#include "../test_utils.h"
+
+const size_t LOCI = 40;
+const size_t CELLS = 50;
+
+CONETInputData<double> create_input_data(Random<double> &random) {
+    std::vector<size_t> chromosome_markers{LOCI / 2, LOCI};
+    std::vector<double> between_bins_lengths;
+    for (size_t i = 0; i < LOCI; i++) {
+        between_bins_lengths.push_back(random.uniform() + 0.5);
+    }
+    CONETInputData<double> data(LOCI, chromosome_markers, between_bins_lengths);
+    for (size_t c = 0; c < CELLS; c++) {
+        std::vector<double> cell;
+        for (size_t i = 0; i < LOCI; i++) {
+            cell.push_back(-std::abs(random.normal()));
+        }
+        data.post_cell(cell);
+    }
+    std::vector<double> regions(LOCI, 1.0);
+    std::vector<std::vector<double>> counts(CELLS, std::vector<double>(LOCI, 2.0));
+    data.post_counts_dispersion_data(regions, counts, counts);
+    return data;
+}
+
+LikelihoodData<double> create_likelihood(Random<double> &random) {
+    Gauss::Gaussian<double> no_breakpoint(0.0, 0.5, random);
+    Gauss::GaussianMixture<double> breakpoint({0.5, 0.5}, {-1.0, -2.0}, {0.3, 0.5}, random);
+    return LikelihoodData<double>(no_breakpoint, breakpoint);
+}
+
+/**
+ * After steps targeting approximate likelihood the sampler should switch back
+ * to the exact likelihood of its current tree, and scores of both fidelities
+ * should be equal to scores calculated from scratch.
+ */
+void approximate_likelihood_test() {
+    BEGIN_TEST;
+    THREADS_LIKELIHOOD = 1;
+    Random<double> random(2137);
+    auto data = create_input_data(random);
+    auto likelihood = create_likelihood(random);
+    std::map<MoveType, double> move_probabilities = {
+        {DELETE_LEAF, 100.0},       {ADD_LEAF, 30.0},     {PRUNE_REATTACH, 30.0},
+        {SWAP_LABELS, 30.0},        {CHANGE_LABEL, 30.0}, {SWAP_SUBTREES, 30.0},
+        {SWAP_ONE_BREAKPOINT, 30.0}};
+    auto subset = data.get_cells_subset(random.subset(CELLS, 10));
+    CountsDispersionPenalty<double> subset_penalty(subset);
+
+    VertexLabelSampler<double> label_sampler{LOCI - 1, data.get_chromosome_end_markers()};
+    EventTree tree = sample_tree(4, label_sampler, random);
+    LikelihoodCoordinator<double> calculator(likelihood, tree, data, 1);
+    TreeSamplerCoordinator<double> sampler(tree, calculator, 7, data, move_probabilities);
+    sampler.enable_approximate_likelihood(subset, 1);
+    sampler.set_temperature(0.1);
+
+    for (size_t i = 0; i < 20; i++) {
+        sampler.set_approximate(i % 2 == 0);
+        sampler.execute_metropolis_hastings_steps(50);
+        LikelihoodCoordinator<double> exact(likelihood, tree, data, 1);
+        LikelihoodCoordinator<double> approximate(likelihood, tree, subset, 1);
+        auto approximate_score = 0.1 * 5.0 * approximate.get_likelihood() +
+                                 subset_penalty.calculate_log_score(
+                                     tree, approximate.get_max_attachment());
+        IS_TRUE(std::abs(sampler.get_tempered_likelihood_with_penalty(0.1, true) -
+                         approximate_score) < 1e-6);
+        sampler.set_approximate(false);
+        IS_TRUE(std::abs(calculator.get_likelihood() - exact.get_likelihood()) < 1e-6);
+    }
+    END_TEST;
+}
+
+int main(void) {
+    approximate_likelihood_test();
+}
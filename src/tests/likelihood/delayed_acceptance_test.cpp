@@ -0,0 +1,95 @@
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+#include "../../src/likelihood_coordinator.h"
+#include "../../src/tree/tree_sampler.h"
+#include "../../src/tree_sampler_coordinator.h"
+#include "../test_utils.h"
+
+const size_t LOCI = 40;
+const size_t CELLS = 50;
+
+CONETInputData<double> create_input_data(Random<double> &random) {
+    std::vector<size_t> chromosome_markers{LOCI / 2, LOCI};
+    std::vector<double> between_bins_lengths;
+    for (size_t i = 0; i < LOCI; i++) {
+        between_bins_lengths.push_back(random.uniform() + 0.5);
+    }
+    CONETInputData<double> data(LOCI, chromosome_markers, between_bins_lengths);
+    for (size_t c = 0; c < CELLS; c++) {
+        std::vector<double> cell;
+        for (size_t i = 0; i < LOCI; i++) {
+            cell.push_back(-std::abs(random.normal()));
+        }
+        data.post_cell(cell);
+    }
+    std::vector<double> regions(LOCI, 1.0);
+    std::vector<std::vector<double>> counts(CELLS, std::vector<double>(LOCI, 2.0));
+    data.post_counts_dispersion_data(regions, counts, counts);
+    return data;
+}
+
+LikelihoodData<double> create_likelihood(Random<double> &random) {
+    Gauss::Gaussian<double> no_breakpoint(0.0, 0.5, random);
+    Gauss::GaussianMixture<double> breakpoint({0.5, 0.5}, {-1.0, -2.0}, {0.3, 0.5}, random);
+    return LikelihoodData<double>(no_breakpoint, breakpoint);
+}
+
+/**
+ * Subset of cells should keep corrected counts and dispersion data of
+ * selected cells.
+ */
+void cells_subset_test() {
+    BEGIN_TEST;
+    Random<double> random(2137);
+    auto data = create_input_data(random);
+    std::vector<size_t> subset_cells{3, 17, 40};
+    auto subset = data.get_cells_subset(subset_cells);
+    IS_EQUAL(subset.get_cells_count(), subset_cells.size());
+    IS_EQUAL(subset.get_loci_count(), data.get_loci_count());
+    for (size_t c = 0; c < subset_cells.size(); c++) {
+        for (size_t i = 0; i < LOCI; i++) {
+            IS_EQUAL(subset.get_corrected_counts()[i][c],
+                     data.get_corrected_counts()[i][subset_cells[c]]);
+        }
+        IS_TRUE(subset.get_summed_counts()[c] == data.get_summed_counts()[subset_cells[c]]);
+        IS_TRUE(subset.get_squared_counts()[c] == data.get_squared_counts()[subset_cells[c]]);
+    }
+    END_TEST;
+}
+
+/**
+ * Likelihood kept by the sampler after steps with delayed acceptance should be
+ * equal to likelihood calculated from scratch for the final tree.
+ */
+void delayed_acceptance_chain_test() {
+    BEGIN_TEST;
+    THREADS_LIKELIHOOD = 1;
+    Random<double> random(2137);
+    auto data = create_input_data(random);
+    auto likelihood = create_likelihood(random);
+    std::map<MoveType, double> move_probabilities = {
+        {DELETE_LEAF, 100.0},       {ADD_LEAF, 30.0},     {PRUNE_REATTACH, 30.0},
+        {SWAP_LABELS, 30.0},        {CHANGE_LABEL, 30.0}, {SWAP_SUBTREES, 30.0},
+        {SWAP_ONE_BREAKPOINT, 30.0}};
+
+    VertexLabelSampler<double> label_sampler{LOCI - 1, data.get_chromosome_end_markers()};
+    EventTree tree = sample_tree(4, label_sampler, random);
+    LikelihoodCoordinator<double> calculator(likelihood, tree, data, 1);
+    TreeSamplerCoordinator<double> sampler(tree, calculator, 7, data, move_probabilities);
+    sampler.enable_delayed_acceptance(10, 1);
+
+    for (size_t i = 0; i < 50; i++) {
+        sampler.execute_metropolis_hastings_steps(20);
+        LikelihoodCoordinator<double> fresh_calculator(likelihood, tree, data, 1);
+        IS_TRUE(std::abs(calculator.get_likelihood() - fresh_calculator.get_likelihood()) <
+                1e-6);
+    }
+    END_TEST;
+}
+
+int main(void) {
+    cells_subset_test();
+    delayed_acceptance_chain_test();
+}
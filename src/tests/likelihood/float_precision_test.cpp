@@ -0,0 +1,92 @@
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+#include "../../src/likelihood_coordinator.h"
+#include "../../src/tree/tree_sampler.h"
+#include "../../src/tree_mh_steps_executor.h"
+#include "../test_utils.h"
+
+const size_t LOCI = 40;
+const size_t CELLS = 300;
+const double MAX_RELATIVE_DRIFT = 1e-5;
+
+template <class Real_t>
+CONETInputData<Real_t> create_input_data(std::vector<std::vector<double>> &cells_data,
+                                         std::vector<double> &lengths) {
+    std::vector<size_t> chromosome_markers{LOCI / 2, LOCI};
+    CONETInputData<Real_t> data(LOCI, chromosome_markers,
+                                std::vector<Real_t>(lengths.begin(), lengths.end()));
+    for (auto &cell_data : cells_data) {
+        std::vector<Real_t> cell(cell_data.begin(), cell_data.end());
+        data.post_cell(cell);
+    }
+    std::vector<Real_t> regions(LOCI, 1.0);
+    std::vector<std::vector<Real_t>> counts(CELLS, std::vector<Real_t>(LOCI, 2.0));
+    data.post_counts_dispersion_data(regions, counts, counts);
+    return data;
+}
+
+template <class Real_t>
+LikelihoodData<Real_t> create_likelihood(Random<Real_t> &random) {
+    Gauss::Gaussian<Real_t> no_breakpoint(0.0, 0.5, random);
+    Gauss::GaussianMixture<Real_t> breakpoint({0.5, 0.5}, {-1.0, -2.0}, {0.3, 0.5}, random);
+    return LikelihoodData<Real_t>(no_breakpoint, breakpoint);
+}
+
+/**
+ * Reports drift of tree likelihood calculated in float precision against
+ * likelihood calculated in double precision, over a sequence of moves.
+ */
+void float_precision_drift_test() {
+    BEGIN_TEST;
+    THREADS_LIKELIHOOD = 1;
+    Random<double> random(2137);
+    Random<float> random_float(2137);
+    std::vector<double> lengths;
+    for (size_t i = 0; i < LOCI; i++) {
+        lengths.push_back(random.uniform() + 0.5);
+    }
+    std::vector<std::vector<double>> cells_data(CELLS);
+    for (auto &cell : cells_data) {
+        for (size_t i = 0; i < LOCI; i++) {
+            cell.push_back(-std::abs(random.normal()));
+        }
+    }
+    auto data = create_input_data<double>(cells_data, lengths);
+    auto data_float = create_input_data<float>(cells_data, lengths);
+
+    VertexLabelSampler<double> label_sampler{LOCI - 1, data.get_chromosome_end_markers()};
+    EventTree tree = sample_tree(8, label_sampler, random);
+    LikelihoodCoordinator<double> coordinator(create_likelihood(random), tree, data, 1);
+    LikelihoodCoordinator<float> coordinator_float(create_likelihood(random_float), tree,
+                                                   data_float, 1);
+    MHStepsExecutor<double> executor(tree, data, random);
+
+    double max_drift = 0.0;
+    for (size_t i = 0; i < 1000; i++) {
+        auto type = static_cast<MoveType>(random.next_int(SWAP_ONE_BREAKPOINT + 1));
+        if (!executor.move_is_possible(type)) {
+            continue;
+        }
+        auto move_data = executor.execute_move(type);
+        const double likelihood = coordinator.calculate_likelihood();
+        const double likelihood_float = coordinator_float.calculate_likelihood();
+        max_drift = std::max(max_drift,
+                             std::abs(likelihood - likelihood_float) / std::abs(likelihood));
+
+        if (random.uniform() < 0.3) {
+            coordinator.persist_likelihood_calculation_result();
+            coordinator_float.persist_likelihood_calculation_result();
+        } else {
+            executor.rollback_move(type, move_data);
+        }
+    }
+    std::cout << "Max relative likelihood drift of float precision: " << max_drift << std::endl;
+    IS_TRUE(max_drift < MAX_RELATIVE_DRIFT);
+    END_TEST;
+}
+
+int main(void) {
+    float_precision_drift_test();
+}
@@ -0,0 +1,119 @@
+#include <cmath>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#include "../../src/likelihood_coordinator.h"
+#include "../../src/tree/tree_sampler.h"
+#include "../../src/tree_sampler_coordinator.h"
+#include "../test_utils.h"
+
+const size_t LOCI = 20;
+const size_t CELLS = 20;
+
+CONETInputData<double> create_input_data(Random<double> &random) {
+    std::vector<size_t> chromosome_markers{LOCI / 2, LOCI};
+    std::vector<double> between_bins_lengths;
+    for (size_t i = 0; i < LOCI; i++) {
+        between_bins_lengths.push_back(random.uniform() + 0.5);
+    }
+    CONETInputData<double> data(LOCI, chromosome_markers, between_bins_lengths);
+    for (size_t c = 0; c < CELLS; c++) {
+        std::vector<double> cell;
+        for (size_t i = 0; i < LOCI; i++) {
+            cell.push_back(-std::abs(random.normal()));
+        }
+        data.post_cell(cell);
+    }
+    std::vector<double> regions(LOCI, 1.0);
+    std::vector<std::vector<double>> counts(CELLS, std::vector<double>(LOCI, 2.0));
+    data.post_counts_dispersion_data(regions, counts, counts);
+    return data;
+}
+
+LikelihoodData<double> create_likelihood(Random<double> &random) {
+    Gauss::Gaussian<double> no_breakpoint(0.0, 0.5, random);
+    Gauss::GaussianMixture<double> breakpoint({0.5, 0.5}, {-1.0, -2.0}, {0.3, 0.5}, random);
+    return LikelihoodData<double>(no_breakpoint, breakpoint);
+}
+
+std::set<std::pair<TreeLabel, TreeLabel>> get_edges(EventTree &tree) {
+    std::set<std::pair<TreeLabel, TreeLabel>> edges;
+    for (auto node : tree.get_descendants(tree.get_root())) {
+        if (node != tree.get_root()) {
+            edges.insert(std::make_pair(tree.get_node_label(tree.get_parent(node)),
+                                        tree.get_node_label(node)));
+        }
+    }
+    return edges;
+}
+
+std::map<std::set<std::pair<TreeLabel, TreeLabel>>, double>
+sample_topologies(bool informed, size_t steps, size_t tries = 1) {
+    THREADS_LIKELIHOOD = 1;
+    Random<double> random(2137);
+    auto data = create_input_data(random);
+    auto likelihood = create_likelihood(random);
+    std::map<MoveType, double> move_probabilities = {{PRUNE_REATTACH, 1.0}};
+
+    VertexLabelSampler<double> label_sampler{LOCI - 1, data.get_chromosome_end_markers()};
+    EventTree tree = sample_tree(4, label_sampler, random);
+    LikelihoodCoordinator<double> calculator(likelihood, tree, data, 1);
+    TreeSamplerCoordinator<double> sampler(tree, calculator, 7, data, move_probabilities);
+    if (informed) {
+        sampler.enable_informed_reattachment();
+    }
+    sampler.enable_multiple_try(tries);
+    sampler.set_temperature(0.02);
+
+    std::map<std::set<std::pair<TreeLabel, TreeLabel>>, double> frequencies;
+    for (size_t i = 0; i < steps; i++) {
+        sampler.execute_metropolis_hastings_step();
+        frequencies[get_edges(tree)] += 1.0 / steps;
+    }
+    return frequencies;
+}
+
+/**
+ * Informed reattachment changes only proposals, so the chain should have the
+ * same stationary distribution of topologies as the chain with uniform
+ * reattachment.
+ */
+void informed_reattachment_stationary_distribution_test() {
+    BEGIN_TEST;
+    const size_t steps = 200000;
+    auto uniform = sample_topologies(false, steps);
+    auto informed = sample_topologies(true, steps);
+    IS_TRUE(uniform.size() > 1);
+    for (auto &topology : uniform) {
+        IS_TRUE(std::abs(topology.second - informed[topology.first]) < 0.02);
+    }
+    for (auto &topology : informed) {
+        IS_TRUE(std::abs(topology.second - uniform[topology.first]) < 0.02);
+    }
+    END_TEST;
+}
+
+/**
+ * Multiple-try Metropolis with informed reattachment should target the same
+ * distribution as well.
+ */
+void informed_multiple_try_stationary_distribution_test() {
+    BEGIN_TEST;
+    const size_t steps = 100000;
+    auto uniform = sample_topologies(false, steps);
+    auto informed = sample_topologies(true, steps, 3);
+    IS_TRUE(uniform.size() > 1);
+    for (auto &topology : uniform) {
+        IS_TRUE(std::abs(topology.second - informed[topology.first]) < 0.02);
+    }
+    for (auto &topology : informed) {
+        IS_TRUE(std::abs(topology.second - uniform[topology.first]) < 0.02);
+    }
+    END_TEST;
+}
+
+int main(void) {
+    informed_reattachment_stationary_distribution_test();
+    informed_multiple_try_stationary_distribution_test();
+}
@@ -0,0 +1,126 @@
+#include <cmath>
+#include <sstream>
+
+#include "../../src/likelihood_coordinator.h"
+#include "../../src/tree/tree_sampler.h"
+#include "../../src/tree_mh_steps_executor.h"
+#include "../test_utils.h"
+
+const size_t LOCI = 40;
+const size_t CELLS = 30;
+// Enough cells to split tree likelihood calculation between threads
+const size_t MANY_CELLS = 1000;
+
+CONETInputData<double> create_input_data(Random<double> &random, size_t cells_count = CELLS) {
+    std::vector<size_t> chromosome_markers{LOCI / 2, LOCI};
+    std::vector<double> between_bins_lengths;
+    for (size_t i = 0; i < LOCI; i++) {
+        between_bins_lengths.push_back(random.uniform() + 0.5);
+    }
+    CONETInputData<double> data(LOCI, chromosome_markers, between_bins_lengths);
+    for (size_t c = 0; c < cells_count; c++) {
+        std::vector<double> cell;
+        for (size_t i = 0; i < LOCI; i++) {
+            cell.push_back(-std::abs(random.normal()));
+        }
+        data.post_cell(cell);
+    }
+    std::vector<double> regions(LOCI, 1.0);
+    std::vector<std::vector<double>> counts(cells_count, std::vector<double>(LOCI, 2.0));
+    data.post_counts_dispersion_data(regions, counts, counts);
+    return data;
+}
+
+LikelihoodData<double> create_likelihood(Random<double> &random) {
+    Gauss::Gaussian<double> no_breakpoint(0.0, 0.5, random);
+    Gauss::GaussianMixture<double> breakpoint({0.5, 0.5}, {-1.0, -2.0}, {0.3, 0.5}, random);
+    return LikelihoodData<double>(no_breakpoint, breakpoint);
+}
+
+std::string to_string(Attachment &attachment) {
+    std::stringstream ss;
+    ss << attachment;
+    return ss.str();
+}
+
+/**
+ * Incrementally calculated likelihood should match likelihood calculated from scratch
+ * after any sequence of accepted and rejected moves.
+ */
+void incremental_likelihood_test(bool use_event_lengths) {
+    BEGIN_TEST;
+    USE_EVENT_LENGTHS_IN_ATTACHMENT = use_event_lengths;
+    THREADS_LIKELIHOOD = 1;
+    Random<double> random(2137);
+    auto data = create_input_data(random);
+    auto likelihood = create_likelihood(random);
+
+    VertexLabelSampler<double> label_sampler{LOCI - 1, data.get_chromosome_end_markers()};
+    EventTree tree = sample_tree(8, label_sampler, random);
+    LikelihoodCoordinator<double> coordinator(likelihood, tree, data, 1);
+    MHStepsExecutor<double> executor(tree, data, random);
+
+    for (size_t i = 0; i < 2000; i++) {
+        auto type = static_cast<MoveType>(random.next_int(SWAP_ONE_BREAKPOINT + 1));
+        if (!executor.move_is_possible(type)) {
+            continue;
+        }
+        auto move_data = executor.execute_move(type);
+        auto incremental = coordinator.calculate_likelihood();
+
+        LikelihoodCoordinator<double> reference(likelihood, tree, data, 1);
+        IS_TRUE(std::abs(incremental - reference.get_likelihood()) <= 1e-8 * std::abs(incremental));
+        IS_EQUAL(to_string(coordinator.calculate_max_attachment()), to_string(reference.get_max_attachment()));
+
+        if (random.uniform() < 0.3) {
+            coordinator.persist_likelihood_calculation_result();
+        } else {
+            executor.rollback_move(type, move_data);
+        }
+    }
+    END_TEST;
+}
+
+/**
+ * Likelihood calculated with many threads should be exactly equal to
+ * likelihood calculated with a single thread.
+ */
+void multithreaded_likelihood_test() {
+    BEGIN_TEST;
+    USE_EVENT_LENGTHS_IN_ATTACHMENT = true;
+    Random<double> random(2137);
+    auto data = create_input_data(random, MANY_CELLS);
+    auto likelihood = create_likelihood(random);
+
+    VertexLabelSampler<double> label_sampler{LOCI - 1, data.get_chromosome_end_markers()};
+    EventTree tree = sample_tree(8, label_sampler, random);
+    LikelihoodCoordinator<double> single_threaded(likelihood, tree, data, 1, 1);
+    LikelihoodCoordinator<double> multithreaded(likelihood, tree, data, 1, 3);
+    IS_EQUAL(single_threaded.get_likelihood(), multithreaded.get_likelihood());
+    MHStepsExecutor<double> executor(tree, data, random);
+
+    for (size_t i = 0; i < 300; i++) {
+        auto type = static_cast<MoveType>(random.next_int(SWAP_ONE_BREAKPOINT + 1));
+        if (!executor.move_is_possible(type)) {
+            continue;
+        }
+        auto move_data = executor.execute_move(type);
+        IS_EQUAL(single_threaded.calculate_likelihood(), multithreaded.calculate_likelihood());
+        IS_EQUAL(to_string(single_threaded.calculate_max_attachment()),
+                 to_string(multithreaded.calculate_max_attachment()));
+
+        if (random.uniform() < 0.3) {
+            single_threaded.persist_likelihood_calculation_result();
+            multithreaded.persist_likelihood_calculation_result();
+        } else {
+            executor.rollback_move(type, move_data);
+        }
+    }
+    END_TEST;
+}
+
+int main(void) {
+    incremental_likelihood_test(true);
+    incremental_likelihood_test(false);
+    multithreaded_likelihood_test();
+}
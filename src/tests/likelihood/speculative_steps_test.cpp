@@ -0,0 +1,96 @@
+#include <cmath>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#include "../../src/likelihood_coordinator.h"
+#include "../../src/tree/tree_sampler.h"
+#include "../../src/tree_sampler_coordinator.h"
+#include "../test_utils.h"
+
+const size_t LOCI = 40;
+const size_t CELLS = 50;
+
+CONETInputData<double> create_input_data(Random<double> &random) {
+    std::vector<size_t> chromosome_markers{LOCI / 2, LOCI};
+    std::vector<double> between_bins_lengths;
+    for (size_t i = 0; i < LOCI; i++) {
+        between_bins_lengths.push_back(random.uniform() + 0.5);
+    }
+    CONETInputData<double> data(LOCI, chromosome_markers, between_bins_lengths);
+    for (size_t c = 0; c < CELLS; c++) {
+        std::vector<double> cell;
+        for (size_t i = 0; i < LOCI; i++) {
+            cell.push_back(-std::abs(random.normal()));
+        }
+        data.post_cell(cell);
+    }
+    std::vector<double> regions(LOCI, 1.0);
+    std::vector<std::vector<double>> counts(CELLS, std::vector<double>(LOCI, 2.0));
+    data.post_counts_dispersion_data(regions, counts, counts);
+    return data;
+}
+
+LikelihoodData<double> create_likelihood(Random<double> &random) {
+    Gauss::Gaussian<double> no_breakpoint(0.0, 0.5, random);
+    Gauss::GaussianMixture<double> breakpoint({0.5, 0.5}, {-1.0, -2.0}, {0.3, 0.5}, random);
+    return LikelihoodData<double>(no_breakpoint, breakpoint);
+}
+
+std::set<std::pair<TreeLabel, TreeLabel>> get_edges(EventTree &tree) {
+    std::set<std::pair<TreeLabel, TreeLabel>> edges;
+    for (auto node : tree.get_descendants(tree.get_root())) {
+        if (node != tree.get_root()) {
+            edges.insert(std::make_pair(tree.get_node_label(tree.get_parent(node)),
+                                        tree.get_node_label(node)));
+        }
+    }
+    return edges;
+}
+
+/**
+ * Chain executed with speculative steps should be exactly the same as the
+ * chain executed with ordinary steps for the same seed, also when single
+ * steps are mixed with batches.
+ */
+void speculative_chain_test(double temperature) {
+    BEGIN_TEST;
+    THREADS_LIKELIHOOD = 1;
+    Random<double> random(2137);
+    auto data = create_input_data(random);
+    auto likelihood = create_likelihood(random);
+    std::map<MoveType, double> move_probabilities = {
+        {DELETE_LEAF, 100.0},       {ADD_LEAF, 30.0},     {PRUNE_REATTACH, 30.0},
+        {SWAP_LABELS, 30.0},        {CHANGE_LABEL, 30.0}, {SWAP_SUBTREES, 30.0},
+        {SWAP_ONE_BREAKPOINT, 30.0}};
+
+    VertexLabelSampler<double> label_sampler{LOCI - 1, data.get_chromosome_end_markers()};
+    EventTree tree = sample_tree(4, label_sampler, random);
+    EventTree speculative_tree = tree;
+    LikelihoodCoordinator<double> calculator(likelihood, tree, data, 1);
+    LikelihoodCoordinator<double> speculative_calculator(likelihood, speculative_tree, data, 1);
+    TreeSamplerCoordinator<double> sampler(tree, calculator, 7, data, move_probabilities);
+    TreeSamplerCoordinator<double> speculative_sampler(speculative_tree, speculative_calculator, 7,
+                                                       data, move_probabilities);
+    sampler.set_temperature(temperature);
+    speculative_sampler.set_temperature(temperature);
+    speculative_sampler.enable_speculative_steps(4);
+
+    for (size_t i = 0; i < 200; i++) {
+        // Batches of 9 steps end with a single step, which is not speculative
+        sampler.execute_metropolis_hastings_steps(9);
+        speculative_sampler.execute_metropolis_hastings_steps(9);
+        sampler.execute_metropolis_hastings_step();
+        speculative_sampler.execute_metropolis_hastings_step();
+        IS_EQUAL(sampler.get_total_likelihood(), speculative_sampler.get_total_likelihood());
+        IS_TRUE(get_edges(tree) == get_edges(speculative_tree));
+    }
+    IS_EQUAL(sampler.get_inferred_tree().likelihood,
+             speculative_sampler.get_inferred_tree().likelihood);
+    END_TEST;
+}
+
+int main(void) {
+    speculative_chain_test(1.0);
+    speculative_chain_test(0.1);
+}
@@ -0,0 +1,70 @@
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+#include "../../src/tree/tree_counts_scoring.h"
+#include "../../src/tree/tree_sampler.h"
+#include "../test_utils.h"
+
+const size_t LOCI = 40;
+const size_t CELLS = 30;
+
+/**
+ * Creates data in which summed and squared counts are sums over regions of
+ * random corrected counts, as in data prepared by the python package.
+ */
+CONETInputData<double> create_input_data(Random<double> &random) {
+    std::vector<size_t> chromosome_markers{LOCI / 2, LOCI};
+    std::vector<double> between_bins_lengths(LOCI, 1.0);
+    CONETInputData<double> data(LOCI, chromosome_markers, between_bins_lengths);
+    std::vector<double> regions;
+    for (size_t i = 0; i < LOCI; i++) {
+        regions.push_back(1 + random.next_int(5));
+    }
+    std::vector<std::vector<double>> summed_counts(CELLS, std::vector<double>(LOCI, 0.0));
+    std::vector<std::vector<double>> squared_counts(CELLS, std::vector<double>(LOCI, 0.0));
+    for (size_t c = 0; c < CELLS; c++) {
+        std::vector<double> cell(LOCI, 0.0);
+        data.post_cell(cell);
+        double cell_mean = 1.0 + 2.0 * random.uniform();
+        for (size_t i = 0; i < LOCI; i++) {
+            for (size_t b = 0; b < regions[i]; b++) {
+                auto count = cell_mean + 0.3 * random.normal();
+                summed_counts[c][i] += count;
+                squared_counts[c][i] += count * count;
+            }
+        }
+    }
+    data.post_counts_dispersion_data(regions, summed_counts, squared_counts);
+    return data;
+}
+
+/**
+ * Counts dispersion penalty of random trees and attachments should never
+ * exceed its upper bound.
+ */
+void counts_penalty_bound_test() {
+    BEGIN_TEST;
+    Random<double> random(2137);
+    auto data = create_input_data(random);
+    VertexLabelSampler<double> label_sampler{LOCI - 1, data.get_chromosome_end_markers()};
+    CountsDispersionPenalty<double> penalty(data);
+    auto bound = penalty.get_log_score_upper_bound();
+    IS_TRUE(bound < 0.0);
+
+    for (size_t i = 0; i < 200; i++) {
+        EventTree tree = sample_tree(1 + random.next_int(15), label_sampler, random);
+        auto nodes = tree.get_descendants(tree.get_root());
+        Attachment attachment(get_root_label(), CELLS, tree.get_node_id(tree.get_root()));
+        for (size_t c = 0; c < CELLS; c++) {
+            auto node = nodes[random.next_int(nodes.size())];
+            attachment.set_attachment(c, tree.get_node_label(node), tree.get_node_id(node));
+        }
+        IS_TRUE(penalty.calculate_log_score(tree, attachment) <= bound);
+    }
+    END_TEST;
+}
+
+int main(void) {
+    counts_penalty_bound_test();
+}
@@ -1,3 +1,7 @@
+#include <fstream>
+#include <map>
+#include <iostream>
+#include <sstream>
 
 #include "../test_utils.h"
 #include "../../src/tree/event_tree.h"
@@ -77,9 +81,357 @@ void prunning_test() {
         std::make_pair(148, 164),
         std::make_pair(105, 106)
     };
-    Attachment at{attachment};
+    Attachment at{get_root_label(), attachment.size()};
+    for (size_t cell = 0; cell < attachment.size(); cell++) {
+        at.set_attachment(cell, attachment[cell], tree.get_node_id(tree.find_node(attachment[cell])));
+    }
     tree.prune_tree(tree.get_root(), at);
 
+    for (auto label : attachment) {
+        IS_TRUE(tree.find_node(label) != EventTree::NULL_NODE);
+    }
+    for (auto node : tree.get_descendants(tree.get_root())) {
+        if (tree.is_leaf(node) && node != tree.get_root()) {
+            IS_TRUE(at.has_attached_cells(tree.get_node_id(node)));
+        }
+    }
+
+    END_TEST;
+}
+
+void node_ids_test() {
+    BEGIN_TEST;
+    std::string tree_str = "(0,0)-(1,10)\n(1,10)-(2,10)\n(0,0)-(3,7)";
+    auto tree = TreeFormatter::from_string_representation(tree_str);
+    IS_EQUAL(tree.get_node_id(tree.get_root()), 0);
+
+    std::vector<bool> used(tree.get_node_id_bound(), false);
+    for (auto node : tree.get_descendants(tree.get_root())) {
+        IS_TRUE(tree.get_node_id(node) < tree.get_node_id_bound());
+        IS_FALSE(used[tree.get_node_id(node)]);
+        used[tree.get_node_id(node)] = true;
+    }
+
+    auto leaf = tree.get_children(tree.get_root()).back();
+    auto leaf_id = tree.get_node_id(leaf);
+    auto parent = tree.delete_leaf(leaf);
+    auto new_leaf = tree.add_leaf(parent, label_from_str("(4,6)"));
+    IS_EQUAL(tree.get_node_id(new_leaf), leaf_id);
+
+    EventTree copy{tree};
+    auto nodes = tree.get_descendants(tree.get_root());
+    auto copied_nodes = copy.get_descendants(copy.get_root());
+    IS_EQUAL(copy.get_node_id_bound(), tree.get_node_id_bound());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        IS_EQUAL(tree.get_node_id(nodes[i]), copy.get_node_id(copied_nodes[i]));
+    }
+    END_TEST;
+}
+
+/**
+ * Children of each node should be kept in the order of attachment while
+ * child blocks are moved and compacted by many structural changes, also in
+ * copies of the tree.
+ */
+void children_order_test() {
+    BEGIN_TEST;
+    Random<double> random(2137);
+    EventTree tree;
+    // Reference children lists, indexed by labels
+    std::map<TreeLabel, std::vector<TreeLabel>> children;
+    std::map<TreeLabel, TreeLabel> parents;
+    size_t next_label = 1;
+    for (size_t i = 0; i < 6000; i++) {
+        auto nodes = tree.get_descendants(tree.get_root());
+        auto node = nodes[random.next_int(nodes.size())];
+        const double operation = random.uniform();
+        // The tree grows first and then shrinks, so that the pool is compacted
+        const double add_probability = i < 3000 ? 0.4 : 0.05;
+        if (operation < add_probability || tree.get_size() < 3) {
+            auto label = std::make_pair(next_label, next_label + 1);
+            next_label++;
+            tree.add_leaf(node, label);
+            children[tree.get_node_label(node)].push_back(label);
+            parents[label] = tree.get_node_label(node);
+        } else if (node != tree.get_root() && operation < add_probability + 0.3) {
+            auto targets = tree.get_non_descendants(node);
+            auto target = targets[random.next_int(targets.size())];
+            auto label = tree.get_node_label(node);
+            auto &siblings = children[parents[label]];
+            siblings.erase(std::find(siblings.begin(), siblings.end(), label));
+            tree.prune_and_reattach(node, target);
+            children[tree.get_node_label(target)].push_back(label);
+            parents[label] = tree.get_node_label(target);
+        } else if (tree.is_leaf(node)) {
+            auto label = tree.get_node_label(node);
+            auto &siblings = children[parents[label]];
+            siblings.erase(std::find(siblings.begin(), siblings.end(), label));
+            tree.delete_leaf(node);
+        }
+    }
+    EventTree copy;
+    copy = tree;
+    for (auto checked : {&tree, &copy}) {
+        size_t nodes_count = 0;
+        for (auto node : checked->get_descendants(checked->get_root())) {
+            std::vector<TreeLabel> node_children;
+            for (auto child : checked->get_children(node)) {
+                IS_EQUAL(checked->get_parent(child), node);
+                node_children.push_back(checked->get_node_label(child));
+            }
+            IS_TRUE(node_children == children[checked->get_node_label(node)]);
+            nodes_count++;
+        }
+        IS_EQUAL(nodes_count, checked->get_size());
+    }
+    IS_EQUAL(TreeFormatter::to_string_representation(tree),
+             TreeFormatter::to_string_representation(copy));
+    END_TEST;
+}
+
+void collect_subtree(EventTree &tree, EventTree::NodeHandle node,
+                     std::vector<EventTree::NodeHandle> &result) {
+    result.push_back(node);
+    for (auto child : tree.get_children(node)) {
+        collect_subtree(tree, child, result);
+    }
+}
+
+bool is_ancestor(EventTree &tree, EventTree::NodeHandle ancestor, EventTree::NodeHandle node) {
+    for (; node != EventTree::NULL_NODE; node = tree.get_parent(node)) {
+        if (node == ancestor) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Descendants, non descendants and relations of nodes, which are answered
+ * from the depth first order of the tree, should match traversals of the
+ * tree after each structural change.
+ */
+void depth_first_order_test() {
+    BEGIN_TEST;
+    Random<double> random(12);
+    EventTree tree;
+    size_t next_label = 1;
+    for (size_t i = 0; i < 1500; i++) {
+        auto nodes = tree.get_descendants(tree.get_root());
+        auto node = nodes[random.next_int(nodes.size())];
+        auto other = nodes[random.next_int(nodes.size())];
+        const double operation = random.uniform();
+        if (operation < 0.35 || tree.get_size() < 3) {
+            tree.add_leaf(node, std::make_pair(next_label, next_label + 1));
+            next_label++;
+        } else if (node == tree.get_root() || other == tree.get_root()) {
+            continue;
+        } else if (operation < 0.55) {
+            if (!is_ancestor(tree, node, other)) {
+                tree.prune_and_reattach(node, other);
+            }
+        } else if (operation < 0.75) {
+            if (!is_ancestor(tree, node, other) && !is_ancestor(tree, other, node)) {
+                tree.swap_subtrees_non_descendants(node, other);
+            }
+        } else if (operation < 0.85) {
+            auto descendant = tree.get_parent(other);
+            if (descendant != node && is_ancestor(tree, node, descendant)) {
+                tree.swap_subtrees_descendants(node, descendant, other);
+            }
+        } else if (tree.is_leaf(node)) {
+            tree.delete_leaf(node);
+        }
+
+        std::vector<EventTree::NodeHandle> expected;
+        collect_subtree(tree, tree.get_root(), expected);
+        nodes = tree.get_descendants(tree.get_root());
+        IS_TRUE(nodes == expected);
+        for (size_t j = 0; j < 5; j++) {
+            node = nodes[random.next_int(nodes.size())];
+            other = nodes[random.next_int(nodes.size())];
+            std::vector<EventTree::NodeHandle> descendants;
+            collect_subtree(tree, node, descendants);
+            std::vector<EventTree::NodeHandle> non_descendants;
+            for (auto n : expected) {
+                if (!is_ancestor(tree, node, n)) {
+                    non_descendants.push_back(n);
+                }
+            }
+            IS_TRUE(tree.get_descendants(node) == descendants);
+            IS_TRUE(tree.get_non_descendants(node) == non_descendants);
+            IS_EQUAL(tree.count_descendants(node), descendants.size());
+            IS_EQUAL(tree.count_non_descendants(node), non_descendants.size());
+            for (size_t k = 0; k < descendants.size(); k++) {
+                IS_EQUAL(tree.get_nth_descendant(node, k), descendants[k]);
+            }
+            for (size_t k = 0; k < non_descendants.size(); k++) {
+                IS_EQUAL(tree.get_nth_non_descendant(node, k), non_descendants[k]);
+            }
+            int relation = 0;
+            if (node != other && is_ancestor(tree, other, node)) {
+                relation = -1;
+            } else if (node != other && is_ancestor(tree, node, other)) {
+                relation = 1;
+            }
+            IS_EQUAL(tree.get_nodes_relation(node, other), relation);
+            IS_EQUAL(tree.is_descendant(other, node), is_ancestor(tree, node, other));
+        }
+    }
+    END_TEST;
+}
+
+std::vector<Locus> get_expected_new_breakpoints(EventTree &tree, EventTree::NodeHandle node) {
+    std::vector<Locus> result;
+    auto label = tree.get_node_label(node);
+    for (Locus br : {label.first, label.second}) {
+        bool inherited = false;
+        for (auto a = tree.get_parent(node); a != tree.get_root(); a = tree.get_parent(a)) {
+            inherited = inherited || tree.get_node_label(a).first == br ||
+                        tree.get_node_label(a).second == br;
+        }
+        if (!inherited) {
+            result.push_back(br);
+        }
+    }
+    return result;
+}
+
+/**
+ * New breakpoints of nodes should match breakpoints of their labels which
+ * do not appear in labels of ancestors, after all kinds of tree changes, in
+ * copies of the tree and after changes of copies.
+ */
+void new_breakpoints_test() {
+    BEGIN_TEST;
+    Random<double> random(31);
+    EventTree tree;
+    auto random_label = [&random]() {
+        Locus first = random.next_int(20);
+        return std::make_pair(first, first + 1 + random.next_int(10));
+    };
+    for (size_t i = 0; i < 1500; i++) {
+        auto nodes = tree.get_descendants(tree.get_root());
+        auto node = nodes[random.next_int(nodes.size())];
+        auto other = nodes[random.next_int(nodes.size())];
+        const double operation = random.uniform();
+        if (operation < 0.3 || tree.get_size() < 3) {
+            tree.add_leaf(node, random_label());
+        } else if (node == tree.get_root() || other == tree.get_root()) {
+            continue;
+        } else if (operation < 0.45) {
+            if (!tree.is_descendant(other, node)) {
+                tree.prune_and_reattach(node, other);
+            }
+        } else if (operation < 0.6) {
+            tree.change_label(node, random_label());
+        } else if (operation < 0.75) {
+            tree.swap_labels(node, other);
+        } else if (operation < 0.85) {
+            if (!tree.is_descendant(other, node) && !tree.is_descendant(node, other)) {
+                tree.swap_subtrees_non_descendants(node, other);
+            }
+        } else if (tree.is_leaf(node)) {
+            tree.delete_leaf(node);
+        }
+        EventTree copy = tree;
+        for (auto checked : {&tree, &copy}) {
+            for (auto n : checked->get_descendants(checked->get_root())) {
+                if (n == checked->get_root()) {
+                    continue;
+                }
+                auto breakpoints = checked->get_new_breakpoints(n);
+                std::vector<Locus> found(breakpoints.begin(), breakpoints.end());
+                IS_TRUE(found == get_expected_new_breakpoints(*checked, n));
+            }
+        }
+        // Copies don't share scratch buffers, the following changes are
+        // applied to a fresh copy or to an assigned one
+        if (i % 2 == 0) {
+            tree = std::move(copy);
+        } else {
+            tree = copy;
+        }
+    }
+    END_TEST;
+}
+
+/**
+ * Node sampler should track nodes and leaves of the tree through additions
+ * and deletions of leaves, which reorder its members.
+ */
+void node_sampler_test() {
+    BEGIN_TEST;
+    Random<double> random(77);
+    EventTree tree;
+    TreeNodeSampler<double> sampler(tree);
+    size_t next_label = 1;
+    for (size_t i = 0; i < 2000; i++) {
+        if (tree.get_size() < 3 || random.uniform() < 0.5) {
+            auto parent = sampler.sample_node(true, random);
+            sampler.refresh_node_data(tree.add_leaf(parent, std::make_pair(next_label, next_label + 1)));
+            sampler.refresh_node_data(parent);
+            next_label++;
+        } else {
+            auto leaf = sampler.sample_leaf(random);
+            IS_TRUE(tree.is_leaf(leaf));
+            sampler.delete_leaf(leaf);
+            sampler.refresh_node_data(tree.delete_leaf(leaf));
+        }
+        size_t leaves = 0;
+        for (auto node : tree.get_descendants(tree.get_root())) {
+            leaves += node != tree.get_root() && tree.is_leaf(node) ? 1 : 0;
+        }
+        IS_EQUAL(sampler.count_leaves(), leaves);
+        IS_EQUAL(sampler.count_nodes(), tree.get_size() - 1);
+        auto node = sampler.sample_node(false, random);
+        IS_TRUE(node != tree.get_root());
+        IS_TRUE(tree.is_descendant(node, tree.get_root()));
+    }
+    END_TEST;
+}
+
+/**
+ * Index of cells attached to nodes should follow changes of the attachment,
+ * both small and large ones, also in copies.
+ */
+void attachment_index_test() {
+    BEGIN_TEST;
+    Random<double> random(5);
+    const size_t cells = 200;
+    const size_t node_ids = 15;
+    Attachment attachment(get_root_label(), cells);
+    std::vector<size_t> expected(cells, 0);
+    for (size_t i = 0; i < 300; i++) {
+        const size_t changes = random.uniform() < 0.2 ? cells : random.next_int(5);
+        for (size_t j = 0; j < changes; j++) {
+            const size_t cell = random.next_int(cells);
+            expected[cell] = random.next_int(node_ids);
+            attachment.set_attachment(cell, std::make_pair(expected[cell], expected[cell] + 1), expected[cell]);
+        }
+        Attachment copy = attachment;
+        for (auto checked : {&attachment, &copy}) {
+            for (size_t id = 0; id < node_ids + 2; id++) {
+                std::vector<size_t> expected_cells;
+                for (size_t cell = 0; cell < cells; cell++) {
+                    if (expected[cell] == id) {
+                        expected_cells.push_back(cell);
+                    }
+                }
+                auto attached = checked->get_attached_cells(id);
+                std::sort(attached.begin(), attached.end());
+                IS_TRUE(attached == expected_cells);
+                IS_EQUAL(checked->count_attached_cells(id), expected_cells.size());
+                IS_EQUAL(checked->has_attached_cells(id), !expected_cells.empty());
+            }
+            std::vector<std::vector<size_t>> node_to_cells;
+            checked->get_node_id_to_cells(node_to_cells, node_ids);
+            for (size_t cell = 0; cell < cells; cell++) {
+                IS_TRUE(std::binary_search(node_to_cells[expected[cell]].begin(),
+                                           node_to_cells[expected[cell]].end(), cell));
+            }
+        }
+    }
     END_TEST;
 }
 
@@ -87,4 +439,10 @@ int main(void) {
     sample_tree_test();
     basic_tree_ops_test();
     prunning_test();
+    node_ids_test();
+    children_order_test();
+    depth_first_order_test();
+    node_sampler_test();
+    new_breakpoints_test();
+    attachment_index_test();
 }
\ No newline at end of file
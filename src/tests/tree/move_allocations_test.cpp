@@ -0,0 +1,115 @@
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "../../src/moves/move_type_scheduler.h"
+#include "../../src/tree/tree_sampler.h"
+#include "../../src/tree_mh_steps_executor.h"
+#include "../test_utils.h"
+
+size_t allocations = 0;
+
+void *operator new(size_t size) {
+    allocations++;
+    void *ptr = std::malloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+template <class F> size_t count_allocations(F f) {
+    const size_t before = allocations;
+    f();
+    return allocations - before;
+}
+
+const size_t LOCI = 40;
+const size_t CELLS = 30;
+
+CONETInputData<double> create_input_data(Random<double> &random) {
+    std::vector<size_t> chromosome_markers{LOCI / 2, LOCI};
+    std::vector<double> between_bins_lengths;
+    for (size_t i = 0; i < LOCI; i++) {
+        between_bins_lengths.push_back(random.uniform() + 0.5);
+    }
+    CONETInputData<double> data(LOCI, chromosome_markers, between_bins_lengths);
+    for (size_t c = 0; c < CELLS; c++) {
+        std::vector<double> cell(LOCI, 0.0);
+        data.post_cell(cell);
+    }
+    return data;
+}
+
+/**
+ * Bookkeeping of MH steps on a tree of constant size should not allocate
+ * memory once buffers have grown: move records, sampling of move types, nodes
+ * and labels, handles refresh and informed reattachment kernels.
+ */
+void steady_state_allocations_test() {
+    BEGIN_TEST;
+    Random<double> random(2137);
+    auto data = create_input_data(random);
+    VertexLabelSampler<double> label_sampler{LOCI - 1, data.get_chromosome_end_markers()};
+    EventTree tree = sample_tree(20, label_sampler, random);
+    MHStepsExecutor<double> executor(tree, data, random);
+    TreeNodeSampler<double> node_sampler(tree);
+    MoveTypeScheduler<double> scheduler(
+        {{PRUNE_REATTACH, 1.0}, {SWAP_LABELS, 1.0}, {CHANGE_LABEL, 1.0},
+         {SWAP_SUBTREES, 1.0}, {SWAP_ONE_BREAKPOINT, 1.0}});
+
+    std::vector<std::vector<bool>> support(LOCI, std::vector<bool>(CELLS));
+    for (size_t l = 0; l < LOCI; l++) {
+        for (size_t c = 0; c < CELLS; c++) {
+            support[l][c] = random.uniform() < 0.3;
+        }
+    }
+    executor.enable_informed_reattachment(support);
+    auto nodes = tree.get_descendants(tree.get_root());
+    Attachment attachment(get_root_label(), CELLS);
+    for (size_t c = 0; c < CELLS; c++) {
+        auto node = nodes[random.next_int(nodes.size())];
+        attachment.set_attachment(c, tree.get_node_label(node), tree.get_node_id(node));
+    }
+    executor.set_attachment(&attachment);
+
+    const size_t warm_up_steps = 10;
+    for (size_t i = 0; i < 1000; i++) {
+        MoveType type;
+        size_t step_allocations =
+            count_allocations([&]() { type = scheduler.sample(random); });
+        if (!executor.move_is_possible(type)) {
+            continue;
+        }
+        auto move_data = executor.execute_move(type);
+        MHStepsExecutor<double>::MoveData copy;
+        step_allocations += count_allocations([&]() {
+            copy = move_data;
+            auto labels = executor.get_node_labels(copy);
+            executor.refresh_node_handles(copy, labels);
+            if (move_data.informed) {
+                executor.complete_reverse_move_log_kernel(move_data, attachment);
+            }
+            auto node = node_sampler.sample_node(false, random);
+            node_sampler.sample_descendant(node, random);
+            node_sampler.sample_non_descendant(node, random);
+            node_sampler.get_swap_subtrees_descendants_kernel(node);
+            label_sampler.sample_label(random);
+        });
+        if (random.uniform() < 0.5) {
+            executor.rollback_move(type, copy);
+        }
+        if (i >= warm_up_steps) {
+            IS_EQUAL(step_allocations, 0);
+        }
+    }
+    END_TEST;
+}
+
+int main(void) {
+    steady_state_allocations_test();
+}
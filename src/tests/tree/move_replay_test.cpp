@@ -0,0 +1,116 @@
+#include <cmath>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#include "../../src/tree/tree_sampler.h"
+#include "../../src/tree_mh_steps_executor.h"
+#include "../test_utils.h"
+
+const size_t LOCI = 40;
+const size_t CELLS = 10;
+
+CONETInputData<double> create_input_data(Random<double> &random) {
+    std::vector<size_t> chromosome_markers{LOCI / 2, LOCI};
+    std::vector<double> between_bins_lengths;
+    for (size_t i = 0; i < LOCI; i++) {
+        between_bins_lengths.push_back(random.uniform() + 0.5);
+    }
+    CONETInputData<double> data(LOCI, chromosome_markers, between_bins_lengths);
+    for (size_t c = 0; c < CELLS; c++) {
+        std::vector<double> cell(LOCI, 0.0);
+        data.post_cell(cell);
+    }
+    std::vector<double> regions(LOCI, 1.0);
+    std::vector<std::vector<double>> counts(CELLS, std::vector<double>(LOCI, 2.0));
+    data.post_counts_dispersion_data(regions, counts, counts);
+    return data;
+}
+
+std::set<std::pair<TreeLabel, TreeLabel>> get_edges(EventTree &tree) {
+    std::set<std::pair<TreeLabel, TreeLabel>> edges;
+    for (auto node : tree.get_descendants(tree.get_root())) {
+        if (node != tree.get_root()) {
+            edges.insert(std::make_pair(tree.get_node_label(tree.get_parent(node)),
+                                        tree.get_node_label(node)));
+        }
+    }
+    return edges;
+}
+
+/**
+ * Move replayed on a copy of the tree should transform it in the same way as
+ * the original move, also after rejected moves executed on the copy.
+ */
+void move_replay_test() {
+    BEGIN_TEST;
+    Random<double> random(2137);
+    Random<double> copy_random(12);
+    auto data = create_input_data(random);
+    VertexLabelSampler<double> label_sampler{LOCI - 1, data.get_chromosome_end_markers()};
+    EventTree tree = sample_tree(8, label_sampler, random);
+    EventTree copy = tree;
+    MHStepsExecutor<double> executor(tree, data, random);
+    MHStepsExecutor<double> copy_executor(copy, data, copy_random);
+
+    for (size_t i = 0; i < 2000; i++) {
+        auto type = static_cast<MoveType>(random.next_int(SWAP_ONE_BREAKPOINT + 1));
+        if (!executor.move_is_possible(type)) {
+            continue;
+        }
+        auto move_data = executor.execute_move(type);
+        auto replay = executor.describe_move(type, move_data);
+        auto replay_data = copy_executor.replay_move(replay);
+        auto replay_labels = copy_executor.get_node_labels(replay_data);
+        IS_TRUE(get_edges(tree) == get_edges(copy));
+
+        auto copy_type = static_cast<MoveType>(copy_random.next_int(SWAP_ONE_BREAKPOINT + 1));
+        if (copy_executor.move_is_possible(copy_type)) {
+            auto copy_move_data = copy_executor.execute_move(copy_type);
+            copy_executor.rollback_move(copy_type, copy_move_data);
+            IS_TRUE(get_edges(tree) == get_edges(copy));
+        }
+
+        if (random.uniform() < 0.3) {
+            executor.rollback_move(type, move_data);
+            copy_executor.refresh_node_handles(replay_data, replay_labels);
+            copy_executor.rollback_move(type, replay_data);
+            IS_TRUE(get_edges(tree) == get_edges(copy));
+        }
+    }
+    END_TEST;
+}
+
+/**
+ * Tree prior maintained by moves and their rollbacks should match the prior
+ * calculated from scratch for the resulting tree.
+ */
+void tree_prior_test() {
+    BEGIN_TEST;
+    Random<double> random(44);
+    auto data = create_input_data(random);
+    VertexLabelSampler<double> label_sampler{LOCI - 1, data.get_chromosome_end_markers()};
+    EventTree tree = sample_tree(8, label_sampler, random);
+    MHStepsExecutor<double> executor(tree, data, random);
+
+    for (size_t i = 0; i < 2000; i++) {
+        auto type = static_cast<MoveType>(random.next_int(SWAP_ONE_BREAKPOINT + 1));
+        if (!executor.move_is_possible(type)) {
+            continue;
+        }
+        auto move_data = executor.execute_move(type);
+        if (random.uniform() < 0.3) {
+            executor.rollback_move(type, move_data);
+        }
+        if (i % 50 == 0) {
+            MHStepsExecutor<double> recalculated(tree, data, random);
+            IS_TRUE(std::abs(executor.get_log_tree_prior() - recalculated.get_log_tree_prior()) < 1e-9);
+        }
+    }
+    END_TEST;
+}
+
+int main(void) {
+    move_replay_test();
+    tree_prior_test();
+}
@@ -1,4 +1,7 @@
 
+#include <map>
+#include <set>
+
 #include "../../src/tree/vertex_label_sampler.h"
 #include "../test_utils.h"
 std::vector<size_t> chromosome_markers{10, 20, 45};
@@ -25,7 +28,171 @@ void basic_operations_test() {
 }
 
 
+/**
+ * Informed sampler should sample only free labels, with frequencies equal to
+ * its kernels, also after changes of the set of free labels.
+ */
+void informed_sampling_test() {
+    BEGIN_TEST;
+    Random<double> random(2137);
+    VertexLabelSampler<double> sampler{max_locus, chromosome_markers};
+    std::vector<TreeLabel> used_labels{std::make_pair(0, 1), std::make_pair(3, 7)};
+    for (auto label : used_labels) {
+        sampler.add_label(label);
+    }
+    std::vector<double> weights;
+    for (size_t i = 0; i <= max_locus; i++) {
+        weights.push_back(0.1 + random.uniform() * (i % 5 == 0 ? 10.0 : 1.0));
+    }
+    sampler.set_locus_weights(weights, used_labels);
+    sampler.add_label(std::make_pair(20, 30));
+    sampler.remove_label(std::make_pair(3, 7));
+
+    std::map<TreeLabel, double> counts;
+    const size_t samples = 200000;
+    for (size_t i = 0; i < samples; i++) {
+        counts[sampler.sample_label(random)]++;
+    }
+    IS_TRUE(counts.find(std::make_pair(0, 1)) == counts.end());
+    IS_TRUE(counts.find(std::make_pair(20, 30)) == counts.end());
+
+    double probabilities_sum = 0.0;
+    for (size_t first = 0; first <= max_locus; first++) {
+        for (size_t second = first + 1; second <= max_locus; second++) {
+            auto label = std::make_pair(first, second);
+            bool valid = false;
+            for (size_t c = 0; c < chromosome_markers.size(); c++) {
+                size_t start = c == 0 ? 0 : chromosome_markers[c - 1];
+                valid = valid || (first >= start && second < chromosome_markers[c]);
+            }
+            if (!valid) {
+                IS_TRUE(counts.find(label) == counts.end());
+                continue;
+            }
+            if (label == std::make_pair((size_t)0, (size_t)1) ||
+                label == std::make_pair((size_t)20, (size_t)30)) {
+                continue;
+            }
+            auto probability = std::exp(sampler.get_sample_label_log_kernel(label));
+            probabilities_sum += probability;
+            IS_TRUE(std::abs(counts[label] / samples - probability) < 0.003);
+        }
+    }
+    IS_TRUE(std::abs(probabilities_sum - 1.0) < 1e-9);
+    END_TEST;
+}
+
+/**
+ * Sampler limited by the maximal event length should sample only labels not
+ * longer than the limit, both uniformly and with informed proposals.
+ */
+void bounded_labels_test() {
+    BEGIN_TEST;
+    Random<double> random(2137);
+    std::vector<double> between_bins_lengths;
+    for (size_t i = 0; i <= max_locus; i++) {
+        between_bins_lengths.push_back(random.uniform() + 0.5);
+    }
+    CONETInputData<double> data(max_locus + 1, chromosome_markers, between_bins_lengths);
+    MAX_EVENT_LOCI = 6;
+    MAX_EVENT_LENGTH = 4.0;
+    VertexLabelSampler<double> sampler{data};
+    MAX_EVENT_LOCI = 0;
+    MAX_EVENT_LENGTH = 0.0;
+
+    std::set<TreeLabel> allowed;
+    for (size_t c = 0; c < chromosome_markers.size(); c++) {
+        size_t start = c == 0 ? 0 : chromosome_markers[c - 1];
+        for (size_t first = start; first < chromosome_markers[c]; first++) {
+            for (size_t second = first + 1; second < chromosome_markers[c]; second++) {
+                auto label = std::make_pair(first, second);
+                if (second - first <= 6 && data.get_event_length(label) <= 4.0) {
+                    allowed.insert(label);
+                }
+            }
+        }
+    }
+    IS_TRUE(std::abs(sampler.get_sample_label_log_kernel() + std::log((double)allowed.size())) < 1e-9);
+    for (size_t i = 0; i < 10000; i++) {
+        IS_TRUE(allowed.count(sampler.sample_label(random)) == 1);
+    }
+    sampler.add_label(std::make_pair(0, 2));
+    sampler.add_label(std::make_pair(3, 5));
+    IS_TRUE(sampler.can_swap_one_breakpoint(std::make_pair(0, 2), std::make_pair(3, 5), 1, 0) ==
+            (allowed.count(std::make_pair(0, 3)) == 1 && allowed.count(std::make_pair(2, 5)) == 1));
+    IS_FALSE(sampler.can_swap_one_breakpoint(std::make_pair(0, 2), std::make_pair(20, 30), 1, 0));
+
+    std::vector<double> weights;
+    for (size_t i = 0; i <= max_locus; i++) {
+        weights.push_back(0.1 + random.uniform());
+    }
+    sampler.set_locus_weights(weights, {std::make_pair(0, 2), std::make_pair(3, 5)});
+    std::map<TreeLabel, double> counts;
+    const size_t samples = 100000;
+    for (size_t i = 0; i < samples; i++) {
+        counts[sampler.sample_label(random)]++;
+    }
+    double probabilities_sum = 0.0;
+    for (auto label : allowed) {
+        if (label == std::make_pair((size_t)0, (size_t)2) ||
+            label == std::make_pair((size_t)3, (size_t)5)) {
+            IS_TRUE(counts.find(label) == counts.end());
+            continue;
+        }
+        auto probability = std::exp(sampler.get_sample_label_log_kernel(label));
+        probabilities_sum += probability;
+        IS_TRUE(std::abs(counts[label] / samples - probability) < 0.005);
+    }
+    IS_TRUE(std::abs(probabilities_sum - 1.0) < 1e-9);
+    END_TEST;
+}
+
+/**
+ * Normaliser of informed kernels should stay equal to the sum of weights of
+ * unused labels after many label changes, also in float precision with a
+ * large label universe.
+ */
+void informed_kernel_drift_test() {
+    BEGIN_TEST;
+    const size_t loci = 2000;
+    Random<float> random(11);
+    std::vector<size_t> markers{loci};
+    std::vector<float> weights;
+    for (size_t l = 0; l < loci; l++) {
+        weights.push_back(0.5f + random.uniform());
+    }
+    VertexLabelSampler<float> sampler{loci - 1, markers};
+    sampler.set_locus_weights(weights, {});
+    std::vector<TreeLabel> used_labels;
+    for (size_t i = 0; i < 200000; i++) {
+        if (used_labels.size() < 500 && random.uniform() < 0.5) {
+            auto label = sampler.sample_label(random);
+            sampler.add_label(label);
+            used_labels.push_back(label);
+        } else if (!used_labels.empty()) {
+            std::swap(used_labels[random.next_int(used_labels.size())], used_labels.back());
+            sampler.remove_label(used_labels.back());
+            used_labels.pop_back();
+        }
+    }
+    double expected_weight = 0.0;
+    for (size_t first = 0; first < loci; first++) {
+        for (size_t second = first + 1; second < loci; second++) {
+            expected_weight += (double)weights[first] * weights[second];
+        }
+    }
+    for (auto label : used_labels) {
+        expected_weight -= (double)weights[label.first] * weights[label.second];
+    }
+    IS_TRUE(std::abs(sampler.get_unused_labels_weight() - expected_weight) <
+            1e-9 * expected_weight);
+    END_TEST;
+}
+
 int main(void) {
     basic_operations_test();
+    informed_sampling_test();
+    bounded_labels_test();
+    informed_kernel_drift_test();
 
 }
\ No newline at end of file
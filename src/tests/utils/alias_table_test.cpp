@@ -0,0 +1,64 @@
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "../../src/moves/move_type_scheduler.h"
+#include "../../src/utils/alias_table.h"
+#include "../test_utils.h"
+
+const size_t SAMPLES = 200000;
+
+/**
+ * Frequencies of sampled values should be close to normalized weights.
+ */
+void alias_table_frequencies_test() {
+    BEGIN_TEST;
+    Random<double> random(2137);
+    std::vector<double> weights{100.0, 30.0, 0.0, 30.0, 5.0, 30.0, 1.0};
+    AliasTable<double> table(weights);
+    std::vector<double> counts(weights.size(), 0.0);
+    for (size_t i = 0; i < SAMPLES; i++) {
+        counts[table.sample(random)]++;
+    }
+    double weights_sum = 0.0;
+    for (auto w : weights) {
+        weights_sum += w;
+    }
+    IS_EQUAL(counts[2], 0.0);
+    for (size_t i = 0; i < weights.size(); i++) {
+        IS_TRUE(std::abs(counts[i] / SAMPLES - weights[i] / weights_sum) < 0.005);
+    }
+    END_TEST;
+}
+
+/**
+ * Adapted weights should move towards the most efficient move type, stay
+ * positive and be frozen after adaptation steps.
+ */
+void move_type_scheduler_adaptation_test() {
+    BEGIN_TEST;
+    Random<double> random(2137);
+    MoveTypeScheduler<double> scheduler({{DELETE_LEAF, 100.0}, {ADD_LEAF, 30.0}, {SWAP_LABELS, 30.0}});
+    scheduler.enable_adaptation(5000);
+    for (size_t i = 0; i < 5000; i++) {
+        auto type = scheduler.sample(random);
+        scheduler.record(type, type == SWAP_LABELS ? 10.0 : 0.0, 10);
+    }
+    IS_TRUE(scheduler.get_weight(SWAP_LABELS) > scheduler.get_weight(DELETE_LEAF));
+    IS_TRUE(scheduler.get_weight(ADD_LEAF) > 0.0);
+    IS_TRUE(scheduler.get_weight(DELETE_LEAF) > 0.0);
+    IS_EQUAL(scheduler.get_weight(CHANGE_LABEL), 0.0);
+
+    const double frozen_weight = scheduler.get_weight(SWAP_LABELS);
+    for (size_t i = 0; i < 5000; i++) {
+        scheduler.record(DELETE_LEAF, 100.0, 1);
+    }
+    IS_EQUAL(scheduler.get_weight(SWAP_LABELS), frozen_weight);
+    END_TEST;
+}
+
+int main(void) {
+    alias_table_frequencies_test();
+    move_type_scheduler_adaptation_test();
+}
@@ -0,0 +1,41 @@
+#include <iostream>
+#include <vector>
+
+#include "../../src/utils/utils.h"
+#include "../test_utils.h"
+
+/**
+ * Lazy updates should keep the same maximum as eager ones, and produce values
+ * only for new maxima.
+ */
+void lazy_update_test() {
+    BEGIN_TEST;
+    Utils::MaxValueAccumulator<std::vector<int>, double> eager;
+    Utils::MaxValueAccumulator<std::vector<int>, double> lazy;
+    std::vector<double> values{-5.0, -7.0, -3.0, -3.0, -4.0, 1.0, 0.5};
+    size_t created = 0;
+    size_t assigned = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        std::vector<int> value(3, (int)i);
+        eager.update(value, values[i]);
+        lazy.update_lazily(
+            values[i],
+            [&]() {
+                created++;
+                return value;
+            },
+            [&](std::vector<int> &stored) {
+                assigned++;
+                stored = value;
+            });
+        IS_TRUE(eager.get() == lazy.get());
+    }
+    IS_EQUAL(created, 1);
+    IS_EQUAL(assigned, 2);
+    IS_EQUAL(lazy.get()[0], 5);
+    END_TEST;
+}
+
+int main(void) {
+    lazy_update_test();
+}
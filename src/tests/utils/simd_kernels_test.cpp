@@ -0,0 +1,180 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../../src/utils/dense_matrix.h"
+#include "../../src/utils/log_sum_accumulator.h"
+#include "../../src/utils/simd_kernels.h"
+#include "../test_utils.h"
+
+const std::vector<Simd::InstructionSet> INSTRUCTION_SETS{
+    Simd::InstructionSet::SSE, Simd::InstructionSet::AVX2,
+    Simd::InstructionSet::AVX512};
+
+/**
+ * Rounded values, so that ties in max updates are frequent.
+ */
+template <class Real_t> AlignedVector<Real_t> random_row(size_t size, std::mt19937 &gen) {
+    std::uniform_int_distribution<int> dist(-4, 4);
+    AlignedVector<Real_t> row(size);
+    for (auto &v : row) {
+        v = dist(gen) / (Real_t)2.0;
+    }
+    return row;
+}
+
+/**
+ * Each vectorized kernel should give exactly the same result as the scalar one.
+ */
+template <class Real_t> void kernels_match_scalar_test() {
+    BEGIN_TEST;
+    std::mt19937 gen(2137);
+    const auto scalar = Simd::get_kernels<Real_t>(Simd::InstructionSet::SCALAR);
+    for (auto set : INSTRUCTION_SETS) {
+        if (!Simd::is_supported(set)) {
+            continue;
+        }
+        const auto kernels = Simd::get_kernels<Real_t>(set);
+        for (size_t size : {0, 1, 3, 8, 17, 64, 101}) {
+            auto a = random_row<Real_t>(size, gen);
+            auto b = random_row<Real_t>(size, gen);
+            auto expected = a, result = a;
+            scalar.add(expected.data(), b.data(), size);
+            kernels.add(result.data(), b.data(), size);
+            IS_TRUE(expected == result);
+
+            scalar.subtract(expected.data(), b.data(), size);
+            kernels.subtract(result.data(), b.data(), size);
+            IS_TRUE(expected == result);
+
+            scalar.add_rows(expected.data(), a.data(), b.data(), size);
+            kernels.add_rows(result.data(), a.data(), b.data(), size);
+            IS_TRUE(expected == result);
+
+            auto expected_max = random_row<Real_t>(size, gen);
+            auto result_max = expected_max;
+            AlignedVector<Real_t> expected_positions(size, 3.0);
+            auto result_positions = expected_positions;
+            for (Real_t position : {5.0, 1.0, 3.0, 0.0}) {
+                auto row = random_row<Real_t>(size, gen);
+                scalar.update_max(expected_max.data(), expected_positions.data(), row.data(), position, size);
+                kernels.update_max(result_max.data(), result_positions.data(), row.data(), position, size);
+                IS_TRUE(expected_max == result_max);
+                IS_TRUE(expected_positions == result_positions);
+            }
+
+            auto args = random_row<Real_t>(size, gen);
+            for (auto &arg : args) {
+                arg *= 40.0;
+            }
+            scalar.exp(expected.data(), args.data(), size);
+            kernels.exp(result.data(), args.data(), size);
+            IS_TRUE(expected == result);
+
+            scalar.log(expected.data(), result.data(), size);
+            kernels.log(result.data(), result.data(), size);
+            IS_TRUE(expected == result);
+        }
+    }
+    END_TEST;
+}
+
+/**
+ * Vectorized exp and log should be accurate up to a few ulps.
+ */
+template <class Real_t> void exp_log_accuracy_test(Real_t tolerance) {
+    BEGIN_TEST;
+    std::vector<Real_t> args;
+    for (Real_t x = -80.0; x <= 80.0; x += 0.0137) {
+        args.push_back(x);
+    }
+    std::vector<Real_t> result(args.size());
+    Simd::exp(result.data(), args.data(), args.size());
+    for (size_t i = 0; i < args.size(); i++) {
+        IS_TRUE(std::abs(result[i] - std::exp(args[i])) <= tolerance * std::exp(args[i]));
+    }
+    std::vector<Real_t> positive;
+    for (Real_t x = 1e-30; x < 1e30; x *= 1.37) {
+        positive.push_back(x);
+    }
+    result.resize(positive.size());
+    Simd::log(result.data(), positive.data(), positive.size());
+    for (size_t i = 0; i < positive.size(); i++) {
+        IS_TRUE(std::abs(result[i] - std::log(positive[i])) <= tolerance * std::max((Real_t)1.0, std::abs(std::log(positive[i]))));
+    }
+
+    Real_t special[] = {0.0, -1.0, std::numeric_limits<Real_t>::infinity(), -1000.0};
+    Real_t special_result[4];
+    Simd::log(special_result, special, 3);
+    IS_TRUE(std::isinf(special_result[0]) && special_result[0] < 0);
+    IS_TRUE(std::isnan(special_result[1]));
+    IS_TRUE(std::isinf(special_result[2]) && special_result[2] > 0);
+    Simd::exp(special_result, special + 2, 2);
+    IS_TRUE(std::isinf(special_result[0]));
+    IS_EQUAL(special_result[1], 0.0);
+    END_TEST;
+}
+
+/**
+ * Vectorized accumulators should match scalar LogWeightAccumulator.
+ */
+void log_weight_accumulators_test() {
+    BEGIN_TEST;
+    const size_t size = 37;
+    std::mt19937 gen(2137);
+    std::normal_distribution<double> dist(-50.0, 20.0);
+    LogWeightAccumulators<double> accumulators(size);
+    std::vector<LogWeightAccumulator<double>> expected(size);
+    std::vector<AlignedVector<double>> rows;
+    for (size_t r = 0; r < 20; r++) {
+        AlignedVector<double> row(size);
+        for (auto &v : row) {
+            v = dist(gen);
+        }
+        accumulators.add(row.data(), 1.5);
+        for (size_t i = 0; i < size; i++) {
+            expected[i].add(row[i] + 1.5);
+        }
+        rows.push_back(row);
+    }
+    for (size_t i = 0; i < size; i++) {
+        IS_TRUE(std::abs(accumulators.get_result(i) - expected[i].get_result()) <= 1e-12 * std::abs(expected[i].get_result()));
+        IS_FALSE(accumulators.is_cancelled(i));
+    }
+
+    for (size_t r = 0; r < rows.size(); r++) {
+        accumulators.remove(rows[r].data(), 1.5);
+    }
+    for (size_t i = 0; i < size; i++) {
+        IS_TRUE(accumulators.is_cancelled(i));
+    }
+    END_TEST;
+}
+
+void dense_matrix_test() {
+    BEGIN_TEST;
+    DenseMatrix<double> matrix(3, 5, 1.0);
+    IS_EQUAL(matrix.stride() % (MATRIX_ALIGNMENT / sizeof(double)), 0);
+    for (size_t row = 0; row < matrix.rows(); row++) {
+        IS_EQUAL(reinterpret_cast<std::uintptr_t>(matrix[row]) % MATRIX_ALIGNMENT, 0);
+    }
+    matrix[2][4] = 2.0;
+    matrix.resize_columns(11, 3.0);
+    IS_EQUAL(matrix.columns(), 11);
+    IS_EQUAL(matrix[2][4], 2.0);
+    IS_EQUAL(matrix[2][5], 3.0);
+    IS_EQUAL(matrix[0][0], 1.0);
+    IS_EQUAL(matrix.flatten().size(), 33);
+    END_TEST;
+}
+
+int main(void) {
+    kernels_match_scalar_test<double>();
+    kernels_match_scalar_test<float>();
+    exp_log_accuracy_test<double>(1e-15);
+    exp_log_accuracy_test<float>(1e-6);
+    log_weight_accumulators_test();
+    dense_matrix_test();
+}